@@ -0,0 +1,514 @@
+/*
+ * OrderedSetBench.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Drives every ordered set in the repository, and the standard library ones,
+ *  through the same workloads so they can be compared and tracked over time.
+ *
+ *  Build with
+ *
+ *  $ g++ -std=c++11 -O2 OrderedSetBench.cpp ../RedBlackTree/RB_Node.cpp -o ordered_set_bench
+ *
+ *  and run as
+ *
+ *  ordered_set_bench [max keys] [ops per workload] > results.csv
+ *
+ *  Sizes go up 10x at a time from 1K keys to max keys (100M by default).  Every
+ *  structure and size runs in a child process of its own, so the peak RSS
+ *  column is that run's alone, and a run that exhausts memory only loses its
+ *  own rows.
+ *
+ *  Workloads, with keys 0, 2, 4 ... 2(n - 1) loaded and odd keys missing:
+ *	sequential insert	build the set from the keys in increasing order
+ *	random insert		build the set from the keys in random order
+ *	random find		uniform lookups over [0, 2n), half of them miss
+ *	zipf find		lookups of loaded keys with Zipfian (theta 0.99) popularity
+ *	range scan		visit the 100 keys from a uniform random point on
+ *	read heavy		95% uniform finds, 5% inserts and erases of odd keys
+ *	write heavy		20% uniform finds, 80% inserts and erases of odd keys
+ *
+ *  Each row has the throughput, the 50th and 99th percentile latency of one
+ *  operation, the run's peak RSS, and the hardware counters per operation
+ *  from perf_event_open.  The counter columns are empty where the kernel or
+ *  the machine does not offer them.  Latency is sampled on at most 1M
+ *  operations of each workload, and the clock reads are included in the
+ *  throughput.
+ */
+
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <errno.h>
+#include <limits.h>
+#include <set>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "../RedBlackTree/RB_Tree.h"
+#include "../RedBlackTree/RB_Pool.h"
+#include "../SkipList/SkipList.cpp"
+
+using namespace std;
+
+class FastRandom{
+
+	private:
+		uint64_t state;
+
+	public:
+		FastRandom(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ull + 1) {}
+		uint64_t next()
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			return state;
+		}
+};
+
+/*
+ * Zipfian ranks in [0, n) after Gray et al., "Quickly Generating
+ * Billion-Record Synthetic Databases", the generator YCSB uses.  Rank 0 is
+ * the most popular.
+ */
+class Zipfian{
+
+	private:
+		double theta;
+		double alpha;
+		double zetaN;
+		double eta;
+		uint64_t n;
+
+		static double zeta(uint64_t n, double theta)
+		{
+			double sum = 0;
+			for(uint64_t i = 1; i <= n; i++)
+				sum += 1 / pow((double) i, theta);
+			return sum;
+		}
+
+	public:
+		Zipfian(uint64_t n, double theta) : theta(theta), n(n)
+		{
+			zetaN = zeta(n, theta);
+			alpha = 1 / (1 - theta);
+			eta = (1 - pow(2.0 / n, 1 - theta)) / (1 - zeta(2, theta) / zetaN);
+		}
+
+		uint64_t next(FastRandom& rng)
+		{
+			double u = (double) (rng.next() >> 11) / (double) (1ull << 53);
+			double uz = u * zetaN;
+			if(uz < 1)
+				return 0;
+			if(uz < 1 + pow(0.5, theta))
+				return 1;
+			uint64_t rank = (uint64_t) (n * pow(eta * u - eta + 1, alpha));
+			return rank < n ? rank : n - 1;
+		}
+};
+
+//Hardware counters for the calling thread, or nothing where they are not available
+class PerfCounters{
+
+	public:
+		static const int EVENTS = 4;
+
+		PerfCounters()
+		{
+			static const uint64_t configs[EVENTS] = {
+				PERF_COUNT_HW_CPU_CYCLES,
+				PERF_COUNT_HW_INSTRUCTIONS,
+				PERF_COUNT_HW_CACHE_MISSES,
+				PERF_COUNT_HW_BRANCH_MISSES
+			};
+			leader = -1;
+			for(int i = 0; i < EVENTS; i++)
+			{
+				struct perf_event_attr attr;
+				memset(&attr, 0, sizeof(attr));
+				attr.size = sizeof(attr);
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.config = configs[i];
+				attr.disabled = i == 0 ? 1 : 0;
+				attr.exclude_kernel = 1;
+				attr.exclude_hv = 1;
+				attr.read_format = PERF_FORMAT_GROUP;
+				fds[i] = (int) syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+				if(fds[i] < 0)
+				{
+					//All or nothing, a partial group would not line up with the columns
+					for(int j = 0; j < i; j++)
+						close(fds[j]);
+					leader = -1;
+					return;
+				}
+				if(i == 0)
+					leader = fds[0];
+			}
+		}
+
+		~PerfCounters()
+		{
+			if(leader >= 0)
+			{
+				for(int i = 0; i < EVENTS; i++)
+					close(fds[i]);
+			}
+		}
+
+		bool available() const
+		{
+			return leader >= 0;
+		}
+
+		void start()
+		{
+			if(leader < 0)
+				return;
+			ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+			ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+		}
+
+		//Fills counts with the events since start, returns false if there are none
+		bool stop(uint64_t* counts)
+		{
+			if(leader < 0)
+				return false;
+			ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+			uint64_t values[1 + EVENTS];
+			if(read(leader, values, sizeof(values)) != (ssize_t) sizeof(values))
+				return false;
+			for(int i = 0; i < EVENTS; i++)
+				counts[i] = values[1 + i];
+			return true;
+		}
+
+	private:
+		int leader;
+		int fds[EVENTS];
+};
+
+/*
+ * One adapter per structure, all with the same four operations.  scan visits
+ * up to count keys from lo on and returns their sum.
+ */
+struct RBTreeSet
+{
+	struct Item : public RB_Node
+	{
+		int key;
+	};
+
+	RB_Tree<Item> tree;
+	RB_Pool pool;
+
+	RBTreeSet() : pool(sizeof(Item), alignof(Item)) {}
+
+	void insert(int key)
+	{
+		Item* item = new (pool.RB_Allocate()) Item();
+		item->key = key;
+		if(tree.RB_InsertUnique(item) != item)
+			pool.RB_Release(item);
+	}
+
+	void erase(int key)
+	{
+		Item* item = tree.RB_Find(key);
+		if(item != NULL)
+		{
+			tree.RB_Delete(item);
+			pool.RB_Release(item);
+		}
+	}
+
+	bool find(int key) { return tree.RB_Find(key) != NULL; }
+
+	long scan(int lo, int count)
+	{
+		long sum = 0;
+		int i = 0;
+		for(Item& item : tree.RB_Range(lo, INT_MAX))
+		{
+			if(i++ == count)
+				break;
+			sum += item.key;
+		}
+		return sum;
+	}
+};
+
+struct SkipListSet
+{
+	SkipList list;
+
+	void insert(int key) { list.insert(key); }
+	void erase(int key) { list.remove(key); }
+	bool find(int key) { return list.search(key); }
+
+	long scan(int lo, int count)
+	{
+		long sum = 0;
+		//The list takes an upper bound rather than a count.  Scans run while
+		//only the even keys are loaded, so this is count keys as well.
+		list.scan(lo, lo + 2 * count, [&](int key) { sum += key; });
+		return sum;
+	}
+};
+
+struct StdSet
+{
+	set<int> keys;
+
+	void insert(int key) { keys.insert(key); }
+	void erase(int key) { keys.erase(key); }
+	bool find(int key) { return keys.find(key) != keys.end(); }
+
+	long scan(int lo, int count)
+	{
+		long sum = 0;
+		set<int>::iterator it = keys.lower_bound(lo);
+		for(int i = 0; i < count && it != keys.end(); i++, ++it)
+			sum += *it;
+		return sum;
+	}
+};
+
+struct StdMap
+{
+	map<int, int> keys;
+
+	void insert(int key) { keys.insert(make_pair(key, key)); }
+	void erase(int key) { keys.erase(key); }
+	bool find(int key) { return keys.find(key) != keys.end(); }
+
+	long scan(int lo, int count)
+	{
+		long sum = 0;
+		map<int, int>::iterator it = keys.lower_bound(lo);
+		for(int i = 0; i < count && it != keys.end(); i++, ++it)
+			sum += it->second;
+		return sum;
+	}
+};
+
+enum OpKind { FIND, INSERT, ERASE, SCAN };
+
+struct Op
+{
+	OpKind kind;
+	int key;
+};
+
+static const int SCAN_LENGTH = 100;
+//Latency samples kept per workload
+static const size_t MAX_SAMPLES = 1 << 20;
+
+//Results of the operations end up here so they cannot be optimized away
+static volatile long benchmarkSink;
+
+static size_t peakRssKb()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return (size_t) usage.ru_maxrss;
+}
+
+/*
+ * Runs ops against set and prints one CSV row.  Every stride-th operation is
+ * timed on its own for the latency percentiles.
+ */
+template <class Set>
+static void runOps(const char* structure, const char* workload, size_t keys, Set& set, const vector<Op>& ops, PerfCounters& counters)
+{
+	size_t stride = ops.size() / MAX_SAMPLES + 1;
+	vector<uint32_t> samples;
+	samples.reserve(ops.size() / stride + 1);
+	long sink = 0;
+
+	counters.start();
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for(size_t i = 0; i < ops.size(); i++)
+	{
+		bool timed = i % stride == 0;
+		chrono::steady_clock::time_point before;
+		if(timed)
+			before = chrono::steady_clock::now();
+		const Op& op = ops[i];
+		switch(op.kind)
+		{
+			case FIND:
+				sink += set.find(op.key) ? 1 : 0;
+				break;
+			case INSERT:
+				set.insert(op.key);
+				break;
+			case ERASE:
+				set.erase(op.key);
+				break;
+			case SCAN:
+				sink += set.scan(op.key, SCAN_LENGTH);
+				break;
+		}
+		if(timed)
+			samples.push_back((uint32_t) chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - before).count());
+	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	uint64_t counts[PerfCounters::EVENTS];
+	bool counted = counters.stop(counts);
+
+	size_t p50 = samples.size() / 2;
+	size_t p99 = samples.size() * 99 / 100;
+	nth_element(samples.begin(), samples.begin() + p50, samples.end());
+	uint32_t p50ns = samples[p50];
+	nth_element(samples.begin(), samples.begin() + p99, samples.end());
+	uint32_t p99ns = samples[p99];
+
+	cout << structure << "," << workload << "," << keys << "," << ops.size() << "," << seconds << ","
+		<< (long) (ops.size() / seconds) << "," << p50ns << "," << p99ns << "," << peakRssKb();
+	for(int e = 0; e < PerfCounters::EVENTS; e++)
+	{
+		cout << ",";
+		if(counted)
+			cout << (double) counts[e] / ops.size();
+	}
+	cout << endl;
+	benchmarkSink = sink;
+}
+
+//Every workload on one structure at one size, run in the child process
+template <class Set>
+static void runStructure(const char* structure, size_t n, size_t opsPerWorkload)
+{
+	PerfCounters counters;
+	FastRandom rng(n);
+	vector<Op> ops;
+
+	{
+		ops.resize(n);
+		for(size_t i = 0; i < n; i++)
+		{
+			ops[i].kind = INSERT;
+			ops[i].key = (int) (i * 2);
+		}
+		Set sequential;
+		runOps(structure, "sequential insert", n, sequential, ops, counters);
+	}
+
+	for(size_t i = n - 1; i > 0; i--)
+		swap(ops[i], ops[rng.next() % (i + 1)]);
+	Set set;
+	runOps(structure, "random insert", n, set, ops, counters);
+
+	ops.resize(opsPerWorkload);
+	for(size_t i = 0; i < opsPerWorkload; i++)
+	{
+		ops[i].kind = FIND;
+		ops[i].key = (int) (rng.next() % (2 * n));
+	}
+	runOps(structure, "random find", n, set, ops, counters);
+
+	//Popular ranks are scattered over the key range, not bunched at the front
+	Zipfian zipf(n, 0.99);
+	for(size_t i = 0; i < opsPerWorkload; i++)
+		ops[i].key = (int) (2 * ((zipf.next(rng) * 2654435761ull) % n));
+	runOps(structure, "zipf find", n, set, ops, counters);
+
+	for(size_t i = 0; i < opsPerWorkload; i++)
+	{
+		ops[i].kind = SCAN;
+		ops[i].key = (int) (rng.next() % (2 * n));
+	}
+	runOps(structure, "range scan", n, set, ops, counters);
+
+	for(int writePercent = 5; writePercent <= 80; writePercent += 75)
+	{
+		for(size_t i = 0; i < opsPerWorkload; i++)
+		{
+			uint64_t r = rng.next();
+			if((int) (r % 100) >= writePercent)
+			{
+				ops[i].kind = FIND;
+				ops[i].key = (int) ((r >> 8) % (2 * n));
+			}
+			else
+			{
+				ops[i].kind = (r >> 7) & 1 ? INSERT : ERASE;
+				ops[i].key = (int) (((r >> 8) % n) * 2 + 1);
+			}
+		}
+		runOps(structure, writePercent == 5 ? "read heavy" : "write heavy", n, set, ops, counters);
+	}
+}
+
+//Runs one structure in a child process, returns false if the child failed
+static bool runIsolated(void (*run)(const char*, size_t, size_t), const char* structure, size_t n, size_t opsPerWorkload)
+{
+	cout.flush();
+	pid_t child = fork();
+	if(child < 0)
+		return false;
+	if(child == 0)
+	{
+		run(structure, n, opsPerWorkload);
+		cout.flush();
+		_exit(0);
+	}
+	int status = 0;
+	while(waitpid(child, &status, 0) < 0)
+	{
+		if(errno != EINTR)
+			return false;
+	}
+	return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char* argv[])
+{
+	size_t maxKeys = argc > 1 ? strtoull(argv[1], NULL, 10) : 100000000;
+	size_t opsPerWorkload = argc > 2 ? strtoull(argv[2], NULL, 10) : 1000000;
+	if(maxKeys > (size_t) 0x3FFFFFFF || opsPerWorkload == 0)
+	{
+		cerr << "Usage: " << argv[0] << " [max keys, below 2^30] [ops per workload]" << endl;
+		return 1;
+	}
+
+	struct Structure
+	{
+		const char* name;
+		void (*run)(const char*, size_t, size_t);
+	};
+	const Structure structures[] = {
+		{ "RB_Tree", &runStructure<RBTreeSet> },
+		{ "SkipList", &runStructure<SkipListSet> },
+		{ "std::set", &runStructure<StdSet> },
+		{ "std::map", &runStructure<StdMap> }
+	};
+
+	PerfCounters probe;
+	if(!probe.available())
+		cerr << "perf_event_open is not available, the counter columns stay empty" << endl;
+
+	cout << "structure,workload,keys,ops,seconds,ops_per_sec,p50_ns,p99_ns,peak_rss_kb,cycles_per_op,instructions_per_op,cache_misses_per_op,branch_misses_per_op" << endl;
+	for(size_t n = 1000; n <= maxKeys; n *= 10)
+	{
+		for(size_t s = 0; s < sizeof(structures) / sizeof(structures[0]); s++)
+		{
+			if(!runIsolated(structures[s].run, structures[s].name, n, opsPerWorkload))
+				cerr << structures[s].name << " failed at " << n << " keys" << endl;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,200 @@
+/*
+ * EpochManager.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Epoch based memory reclamation for the lock-free structures, shared by the
+ *  concurrent skip lists and RB_PersistentTree.
+ *
+ *  A thread enters an epoch before it touches shared nodes and leaves it when it
+ *  is done.  Unlinked nodes are not freed right away, they are retired and tagged
+ *  with the global epoch at the time they were unlinked.  The global epoch only
+ *  advances once every active thread has caught up with it, so once it is two
+ *  ahead of a tag every thread that could have seen the node has left.
+ */
+
+#ifndef EPOCHMANAGER_H_
+#define EPOCHMANAGER_H_
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+class EpochManager{
+
+	private:
+		struct Retired{
+			void* object;
+			void (*deleter)(void*);
+			unsigned epoch;
+		};
+
+		//One record per thread that has ever used the manager.  Records are never
+		//unlinked, a thread that exits hands its record back for reuse.
+		struct ThreadRecord{
+			std::atomic<unsigned> epoch;
+			std::atomic<bool> active;
+			std::atomic<bool> inUse;
+			unsigned depth;
+			unsigned lastSeen;
+			std::vector<Retired> retired;
+			//Size of retired at which the next collect is tried
+			size_t collectAt;
+			ThreadRecord* next;
+		};
+
+		//Owns the calling thread's record and releases it when the thread exits
+		struct ThreadHandle{
+			ThreadRecord* record;
+			ThreadHandle() : record(NULL) {}
+			~ThreadHandle()
+			{
+				if(record != NULL)
+					EpochManager::instance().release(record);
+			}
+		};
+
+		//How many nodes a thread retires before it tries to move the epoch forward
+		static const size_t RETIRE_THRESHOLD = 64;
+
+		std::atomic<unsigned> globalEpoch;
+		std::atomic<ThreadRecord*> records;
+
+		EpochManager() : globalEpoch(0), records(NULL) {}
+		EpochManager(const EpochManager&);
+		EpochManager& operator=(const EpochManager&);
+
+		ThreadRecord* acquire()
+		{
+			//Reuse a record left behind by an exited thread if we can
+			for(ThreadRecord* r = records.load(); r != NULL; r = r->next)
+			{
+				bool expected = false;
+				if(!r->inUse.load() && r->inUse.compare_exchange_strong(expected, true))
+					return r;
+			}
+
+			ThreadRecord* r = new ThreadRecord();
+			r->epoch.store(0);
+			r->active.store(false);
+			r->inUse.store(true);
+			r->depth = 0;
+			r->lastSeen = 0;
+			r->collectAt = RETIRE_THRESHOLD;
+			r->next = records.load();
+			while(!records.compare_exchange_weak(r->next, r))
+				;
+			return r;
+		}
+
+		void release(ThreadRecord* r)
+		{
+			//Whatever is still pending is handed to the next owner of the record,
+			//it will be freed once the epoch moves on.
+			r->active.store(false);
+			r->inUse.store(false);
+		}
+
+		ThreadRecord* record()
+		{
+			static thread_local ThreadHandle handle;
+			if(handle.record == NULL)
+				handle.record = acquire();
+			return handle.record;
+		}
+
+		//Frees every retired object whose tag is at least two epochs old
+		static void collect(std::vector<Retired>& retired, unsigned e)
+		{
+			size_t kept = 0;
+			for(size_t i = 0; i < retired.size(); i++)
+			{
+				if(e - retired[i].epoch >= 2)
+					retired[i].deleter(retired[i].object);
+				else
+					retired[kept++] = retired[i];
+			}
+			retired.resize(kept);
+		}
+
+		bool tryAdvance()
+		{
+			unsigned e = globalEpoch.load();
+			for(ThreadRecord* r = records.load(); r != NULL; r = r->next)
+			{
+				if(r->active.load() && r->epoch.load() != e)
+					return false;
+			}
+			return globalEpoch.compare_exchange_strong(e, e + 1);
+		}
+
+	public:
+		static EpochManager& instance()
+		{
+			static EpochManager manager;
+			return manager;
+		}
+
+		//Marks the calling thread as reading shared nodes.  Calls may nest.
+		void enter()
+		{
+			ThreadRecord* r = record();
+			if(r->depth++ > 0)
+				return;
+
+			unsigned e = globalEpoch.load();
+			r->epoch.store(e);
+			r->active.store(true);
+			//Publish that we are active before we read any node
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			e = globalEpoch.load();
+			r->epoch.store(e);
+
+			if(e != r->lastSeen)
+			{
+				collect(r->retired, e);
+				r->lastSeen = e;
+			}
+		}
+
+		void exit()
+		{
+			ThreadRecord* r = record();
+			if(--r->depth == 0)
+				r->active.store(false, std::memory_order_release);
+		}
+
+		//Defers deleter(object) until no thread can still hold a reference to it.
+		//Must be called from inside enter()/exit().
+		void retire(void* object, void (*deleter)(void*))
+		{
+			ThreadRecord* r = record();
+			//Tag with the global epoch, read after the object was unlinked
+			Retired item = { object, deleter, globalEpoch.load() };
+			r->retired.push_back(item);
+			if(r->retired.size() >= r->collectAt)
+			{
+				tryAdvance();
+				collect(r->retired, globalEpoch.load());
+				//While some reader holds the epoch back little gets freed, so wait
+				//for the list to double before scanning it again
+				r->collectAt = r->retired.size() * 2;
+				if(r->collectAt < RETIRE_THRESHOLD)
+					r->collectAt = RETIRE_THRESHOLD;
+			}
+		}
+};
+
+//Scoped helper so every early return leaves the epoch
+class EpochGuard{
+
+	public:
+		EpochGuard() { EpochManager::instance().enter(); }
+		~EpochGuard() { EpochManager::instance().exit(); }
+
+	private:
+		EpochGuard(const EpochGuard&);
+		EpochGuard& operator=(const EpochGuard&);
+};
+
+#endif /* EPOCHMANAGER_H_ */
@@ -0,0 +1,118 @@
+/*
+ * ThreadCounters.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Per-thread event counters that are summed on demand.
+ *
+ *  Every thread that counts anything gets a record of its own, so a hot path
+ *  adds to memory no other thread writes: a plain load and store, with no
+ *  locked instruction and no cache line bouncing between cores.  snapshot()
+ *  walks every record and adds them up.  It may run at any time from any
+ *  thread.  It always includes the calling thread's own counts, and other
+ *  threads' counts show up in it shortly after they are made.  Counters only
+ *  grow, so the counts over an interval are the difference of two snapshots.
+ *
+ *  Records are never freed.  Like the EpochManager's, a thread that exits hands
+ *  its record on to the next new thread, counts and all, so nothing counted
+ *  is ever lost.  Tag keeps the counters of different users apart, SkipListStats
+ *  and RB_Stats each have their own.
+ */
+
+#ifndef THREADCOUNTERS_H_
+#define THREADCOUNTERS_H_
+
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+
+template <class Tag, int N>
+class ThreadCounters{
+
+	private:
+		struct Record{
+			//Keeps the counts of two threads off each other's cache lines
+			char before[64];
+			std::atomic<uint64_t> values[N];
+			char after[64];
+			std::atomic<bool> inUse;
+			Record* next;
+		};
+
+		//Owns the calling thread's record and releases it when the thread exits
+		struct Handle{
+			Record* record;
+			Handle() : record(NULL) {}
+			~Handle()
+			{
+				if(record != NULL)
+					record->inUse.store(false);
+			}
+		};
+
+		static std::atomic<Record*>& records()
+		{
+			static std::atomic<Record*> head(NULL);
+			return head;
+		}
+
+		static Record* acquire()
+		{
+			for(Record* r = records().load(); r != NULL; r = r->next)
+			{
+				bool expected = false;
+				if(!r->inUse.load() && r->inUse.compare_exchange_strong(expected, true))
+					return r;
+			}
+
+			Record* r = new Record();
+			for(int i = 0; i < N; i++)
+				r->values[i].store(0);
+			r->inUse.store(true);
+			r->next = records().load();
+			while(!records().compare_exchange_weak(r->next, r))
+				;
+			return r;
+		}
+
+		static Record* attach()
+		{
+			static thread_local Handle handle;
+			handle.record = acquire();
+			return handle.record;
+		}
+
+		static Record* local()
+		{
+			//A plain pointer needs no destructor, so reading it is a single TLS load
+			static thread_local Record* record = NULL;
+			if(record == NULL)
+				record = attach();
+			return record;
+		}
+
+	public:
+		static const int COUNTERS = N;
+
+		//Adds n to counter i of the calling thread
+		static void add(int i, uint64_t n = 1)
+		{
+			std::atomic<uint64_t>& v = local()->values[i];
+			//Only this thread writes v, so no read-modify-write is needed
+			v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+		}
+
+		//Fills out[0..N) with the sum over every thread
+		static void snapshot(uint64_t* out)
+		{
+			for(int i = 0; i < N; i++)
+				out[i] = 0;
+			for(Record* r = records().load(); r != NULL; r = r->next)
+			{
+				for(int i = 0; i < N; i++)
+					out[i] += r->values[i].load(std::memory_order_relaxed);
+			}
+		}
+};
+
+#endif /* THREADCOUNTERS_H_ */
@@ -0,0 +1,243 @@
+/*
+ * Benchmark.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Timing driver for the LCS engines in LCS.c.
+ *
+ *  Build with
+ *
+ *  $ gcc -std=gnu99 -O2 -pthread Benchmark.c -o lcs_bench
+ *
+ *  and run as
+ *
+ *  lcs_bench <mode> [args]
+ *
+ *  modes:
+ *	bitparallel [max-length]	LCS length of two random sequences: the scalar table against the portable, AVX2 and AVX-512 bit-parallel loops
+ *	alignment [max-length]		whole sequence --show-all-lines alignment: time and peak memory of the dp table, hirschberg and myers
+ *	wavefront [length] [max-threads]	strong scaling of the wavefront engine on one alignment of two related sequences, 1, 2, 4, ... threads
+ */
+
+#define LCS_NO_MAIN
+#include "LCS.c"
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+static double seconds_since(const struct timespec* start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+//Random symbols from an alphabet of the given size, like a DNA sequence for 4
+static int* random_sequence(int length, int alphabet, unsigned seed)
+{
+	int* s = malloc(sizeof(int) * length);
+	int i;
+
+	srand(seed);
+	for(i = 0; i < length; i++)
+		s[i] = rand() % alphabet;
+	return s;
+}
+
+//The LCS length one cell at a time, as the table in dp_diff fills it, keeping two rows
+static int scalar_lcs_length(const int* x, int M, const int* y, int N)
+{
+	int* previous = calloc(N + 1, sizeof(int));
+	int* current = calloc(N + 1, sizeof(int));
+	int* t;
+	int i, j, length;
+
+	for(i = 0; i < M; i++)
+	{
+		for(j = 0; j < N; j++)
+		{
+			if(x[i] == y[j])
+				current[j + 1] = previous[j] + 1;
+			else
+				current[j + 1] = max(previous[j + 1], current[j]);
+		}
+		t = previous, previous = current, current = t;
+	}
+	length = previous[N];
+	free(previous);
+	free(current);
+	return length;
+}
+
+static void bench_bitparallel(int max_length)
+{
+	static const char* names[] = { "portable", "avx2", "avx512" };
+	int length, k, lcs;
+	int* x;
+	int* y;
+	double scalar, s;
+	struct timespec start;
+
+	printf("kernel,length,seconds,cells_per_ns,speedup,lcs\n");
+	for(length = 1000; length <= max_length; length *= 4)
+	{
+		x = random_sequence(length, 4, 1);
+		y = random_sequence(length, 4, 2);
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		lcs = scalar_lcs_length(x, length, y, length);
+		scalar = seconds_since(&start);
+		printf("scalar,%d,%f,%f,1.0,%d\n", length, scalar, (double) length * length / scalar / 1e9, lcs);
+
+		for(k = 0; k < 3; k++)
+		{
+			//bit_lcs_length picks its loop once, from LCS_SIMD, so each kernel runs in a child of its own
+			fflush(stdout);
+			if(fork() == 0)
+			{
+				setenv("LCS_SIMD", names[k], 1);
+				if(k > 0 && bit_lcs_rows() == bit_lcs_rows_portable)
+				{
+					printf("%s,%d,unsupported\n", names[k], length);
+					exit(0);
+				}
+				clock_gettime(CLOCK_MONOTONIC, &start);
+				lcs = bit_lcs_length(x, length, y, length);
+				s = seconds_since(&start);
+				printf("%s,%d,%f,%f,%.1f,%d\n", names[k], length, s, (double) length * length / s / 1e9, scalar / s, lcs);
+				exit(0);
+			}
+			wait(NULL);
+		}
+		free(x);
+		free(y);
+	}
+}
+
+//Folds an edit script into a checksum, so engines can be seen to agree without keeping their output
+static void checksum_run(void* context, int op, int x_start, int y_start, int count)
+{
+	uint64_t* sum = context;
+	int i;
+
+	for(i = 0; i < count; i++)
+		*sum = (*sum ^ (uint64_t) (op + 1)) * 0x100000001B3ULL;
+	(void) x_start;
+	(void) y_start;
+}
+
+static void bench_alignment(int max_length)
+{
+	static const char* names[] = { "dp", "hirschberg", "myers" };
+	static const int engines[] = { ALGORITHM_DP, ALGORITHM_HIRSCHBERG, ALGORITHM_MYERS };
+	int length, k, i;
+	int* x;
+	int* y;
+	uint64_t sum;
+	edit_sink sink;
+	struct rusage usage;
+	struct timespec start;
+	double s;
+
+	printf("engine,length,seconds,max_rss_mb,checksum\n");
+	for(length = 1000; length <= max_length; length *= 4)
+	{
+		//Two related sequences, the second with one symbol in a hundred changed
+		x = random_sequence(length, 4, 1);
+		y = random_sequence(length, 4, 1);
+		srand(3);
+		for(i = 0; i < length / 100; i++)
+			y[rand() % length] = rand() % 4;
+
+		for(k = 0; k < 3; k++)
+		{
+			//The table is (length + 1)^2 ints
+			if(engines[k] == ALGORITHM_DP && length > 16000)
+				continue;
+			//Each engine runs in a child of its own so the peak memory is its own
+			fflush(stdout);
+			if(fork() == 0)
+			{
+				sum = 0;
+				sink.emit = checksum_run;
+				sink.context = &sum;
+				clock_gettime(CLOCK_MONOTONIC, &start);
+				run_diff(engines[k], x, length, y, length, &sink);
+				s = seconds_since(&start);
+				getrusage(RUSAGE_SELF, &usage);
+				printf("%s,%d,%f,%.1f,%016llx\n", names[k], length, s, usage.ru_maxrss / 1024.0, (unsigned long long) sum);
+				exit(0);
+			}
+			wait(NULL);
+		}
+		free(x);
+		free(y);
+	}
+}
+
+static void bench_wavefront(int length, int max_threads)
+{
+	int* x = random_sequence(length, 4, 1);
+	int* y = random_sequence(length, 4, 1);
+	int threads, i;
+	uint64_t sum;
+	edit_sink sink;
+	struct timespec start;
+	double s, one = 0;
+
+	//A hundredth of the symbols changed, as between two assemblies of the same genome
+	srand(3);
+	for(i = 0; i < length / 100; i++)
+		y[rand() % length] = rand() % 4;
+
+	printf("threads,length,seconds,cells_per_ns,speedup,efficiency,checksum\n");
+	for(threads = 1; threads <= max_threads; threads = threads < max_threads && threads * 2 > max_threads ? max_threads : threads * 2)
+	{
+		sum = 0;
+		sink.emit = checksum_run;
+		sink.context = &sum;
+		wavefront_threads = threads;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		wavefront_diff(x, length, y, length, &sink);
+		s = seconds_since(&start);
+		if(threads == 1)
+			one = s;
+		printf("%d,%d,%f,%f,%.2f,%.2f,%016llx\n", threads, length, s, (double) length * length / s / 1e9, one / s, one / s / threads, (unsigned long long) sum);
+		fflush(stdout);
+		if(threads == max_threads)
+			break;
+	}
+	free(x);
+	free(y);
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc < 2)
+	{
+		printf("Usage: %s bitparallel|alignment|wavefront [args]\n", argv[0]);
+		return 1;
+	}
+
+	if(strcmp(argv[1], "bitparallel") == 0)
+	{
+		bench_bitparallel(argc > 2 ? atoi(argv[2]) : 64000);
+		return 0;
+	}
+
+	if(strcmp(argv[1], "alignment") == 0)
+	{
+		bench_alignment(argc > 2 ? atoi(argv[2]) : 256000);
+		return 0;
+	}
+
+	if(strcmp(argv[1], "wavefront") == 0)
+	{
+		bench_wavefront(argc > 2 ? atoi(argv[2]) : 2000000, argc > 3 ? atoi(argv[3]) : (int) sysconf(_SC_NPROCESSORS_ONLN));
+		return 0;
+	}
+
+	printf("Unknown mode %s\n", argv[1]);
+	return 1;
+}
@@ -1,24 +1,40 @@
 /*
  *
  * Inputs:
- *	Two file paths which we should diff.  Options arguments include --show-all-lines as explained below.
+ *	Two file paths which we should diff.  Options arguments include --show-all-lines, --algorithm and --width as explained below.
  *
  * Outputs:
- *	By default the input files are broken into 70 character 'lines'.  When two of these lines are determined to be different, they are displayed to the screen.
- *	Lines prefixed with > are from the first file.
- *	Lines prefixed with < are from the second file.
- *	The output will also display the following message:  Difference located at <File1>:[start-index]-[end-index] and <file2>:[start-index]-end[index]
+ *	By default the files are compared line by line, where a line ends at a newline, and the differences are printed the way diff prints them:
+ *	a command such as 3,5c3,4 giving the line numbers, then the lines from the first file prefixed with <, --- and the lines from the second file prefixed with >.
  *	This is the same output from diff as seen on linux.
- *	If the --show-all-lines option is included the output will be the merged version of two files with > indicating changes from the first file and < being differences from the second.
+ *
+ *	With --width=N the input files are instead broken into N character 'lines' (70 unless given).  When two of these lines are determined to be different, they are displayed to the screen.
+ *	Lines prefixed with < are from the first file.
+ *	Lines prefixed with > are from the second file.
+ *	The output will also display the following message:  Difference located at <File1>:[start-index]-[end-index] and <file2>:[start-index]-end[index]
+ *	If the --show-all-lines option is included the output will be the merged version of two fixed width files with > indicating changes from the first file and < being differences from the second.
+ *	If the --similarity option is included each pair of fixed width lines that differ is followed by how similar they are, from 0% to 100%.
  *
  * Summary:
  * 	Diff Program using a LCS algorithm as a base.
- * 	Uses a defined line size to deal with very large files.
  *
- * 	Uses LCS algorithm as described in CLRS "Introduction to Algorithms"  3rd Edition.
+ *	Lines are interned first: every distinct line gets a small integer id from a hash table, so a line is hashed once and after that
+ *	comparing two lines is comparing two integers.  The diff engines then run over the sequences of ids, which are far shorter than the files.
+ *
+ * 	By default each pair of lines is diffed with Myers' O(ND) algorithm ("An O(ND) Difference Algorithm and Its Variations", 1986).
+ *	It walks the diagonals of the edit graph outwards from both corners and stops where the two searches meet, so the work grows
+ *	with the number of differences D rather than with the size of the lines, and only O(M+N) memory is needed.
+ *	Nearly identical files are cheap no matter how long the lines are.
+ *
+ *	Similarity scores come from a bit-parallel LCS length that works through 64 columns of the table per machine word.
+ *
+ * 	The LCS algorithm as described in CLRS "Introduction to Algorithms"  3rd Edition is kept as a reference (--algorithm=dp).
  *	Basically, we build our LCS sub-problem solutions table and we can then use those values to determine when our files differed.
+ *	The table needs O(MN) memory.  --algorithm=hirschberg gives exactly the same result in O(M+N) memory, so with --width=0
+ *	sequences of hundreds of thousands of characters can be aligned whole.
+ *	--algorithm=wavefront gives the same result again and spreads the table over every core, for aligning whole genomic files.
  *
- * 	This is going to do the same thing as the following shell commands:
+ * 	With --width=N this is going to do the same thing as the following shell commands:
  *
  * 	$ fold ACGT_x -w 70 > ACGT_x_lines
  * 	$ fold ACGT_y -w 70 > ACGT_y_lines
@@ -27,14 +43,22 @@
  * 	I had always wondered how diff would work so I decided to program it instead of just using a script.
  *		
  *
- *	Output is fairly simple, it dumps out the 70 character 'lines' as diff does when run as outlined above.
+ *	Output is fairly simple, it dumps out the fixed width 'lines' as diff does when run as outlined above.
  *	See below for optional argument outputs
  *
+ * 	The program is built with
+ *
+ * 	$ gcc -O2 -pthread LCS.c -o find_diff
+ *
  * 	The program should be run as follows
  *
  * 	find_diff File1 File2 [optional-args]
  *
- * 	optional-args = --show-all-lines which allows the entire contents to be dumped to stdout
+ * 	optional-args = --show-all-lines which allows the entire contents to be dumped to stdout, using fixed width lines
+ *			--algorithm=myers|dp|hirschberg|wavefront picks the diff engine, myers is the default
+ *			--threads=N sets how many threads the wavefront engine uses, one per processor by default
+ *			--width=N switches to fixed width lines of N characters, 0 makes each file one line
+ *			--similarity scores each pair of fixed width lines that differ, using the bit-parallel LCS length
  * 
  * Notes: 
  *	 I highly recommend redirecting stdout to a file if you run the above command.  Even with | more, it is hard to read.
@@ -46,11 +70,36 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
 
 
-//Process 70 characters at a time for memory
+//Process 70 characters at a time for memory in fixed width mode
 #define LINE_SIZE 70
 
+//Diff engines, selected with --algorithm
+#define ALGORITHM_MYERS 0
+#define ALGORITHM_DP 1
+#define ALGORITHM_HIRSCHBERG 2
+#define ALGORITHM_WAVEFRONT 3
+
+//Steps of an edit script
+#define EDIT_COMMON 0
+#define EDIT_DELETE 1
+#define EDIT_INSERT 2
+
+/*
+ * An edit script is handed out as runs, in order from the start of both sequences.
+ * A run covers count symbols starting at x_start in the first sequence (EDIT_COMMON, EDIT_DELETE)
+ * and at y_start in the second (EDIT_COMMON, EDIT_INSERT).
+ */
+typedef struct edit_sink
+{
+	void (*emit)(void* context, int op, int x_start, int y_start, int count);
+	void* context;
+} edit_sink;
+
 /*
  * Name:
  *	int max(int a, int b)
@@ -70,6 +119,12 @@ int max(int a, int b)
   return a > b ? a : b;
 }
 
+//The smaller of the two arguments
+int min(int a, int b)
+{
+  return a < b ? a : b;
+}
+
 /*
  * Name:
  *	char* get_file_contents(char* path, int* length)
@@ -133,256 +188,2008 @@ char* get_file_contents(char* path, int* length)
 	  return buffer;
 }
 
-int main(int argc, char* argv[])
+/*
+ * Name:
+ *	int* get_symbols(const char* text, int length)
+ *
+ * Input:
+ *	A buffer and its length
+ *
+ * Output:
+ *	Returns the buffer as an array of symbols, one per byte, which is what the diff engines compare.
+ *
+ * Side Effects:
+ *	The caller is responsible for freeing the array.
+ *
+ */
+int* get_symbols(const char* text, int length)
 {
-	//Optional argument switch
-	int show_all_lines = 0;
-
-	//File contents pointers
-	char* sequence_x = NULL;
-	char* sequence_y = NULL;
-
-	//Total file lengths
-	int sequence_x_length = 0;
-	int sequence_y_length = 0;
-
-	//Line buffers
-	char x_line[LINE_SIZE + 1];
-	char y_line[LINE_SIZE + 1];
-
-	//Buffer counters, should be length 70 or less
-	int x_line_length = 0;
-	int y_line_length = 0;
-	
-	
-	//Index counters, used to keep track of how much we have read relative to the entire file size
-	int x_idx = 0;
-	int y_idx = 0;
+	int i;
+	int* symbols = malloc(sizeof(int) * (length > 0 ? length : 1));
 
-	//Boolean switches to indicate when we are done processing each of our files.
-	int x_done = 0;
-	int y_done = 0;
-	
-	//Loop counters
-	int i = 0;
-	int j = 0;
-	int diff_count = 0;
-	
-	//Length counters.  M is the length of our buffer for file 1, N is the length of our buffer for file 2
-	int M = 0;
-	int N = 0;
+	if(symbols == NULL)
+	{
+		puts("Memory allocation error.  Program will stop.");
+		exit (1);
+	}
+	for(i = 0; i < length; i++)
+		symbols[i] = (unsigned char) text[i];
+	return symbols;
+}
 
-	//This is the pointer to our dynamic programming result table
-	int** C = NULL;
+/*
+ * Name:
+ *	static void dp_diff_at(const int* x, int M, const int* y, int N, int x_base, int y_base, edit_sink* sink)
+ *
+ * Input:
+ *	The two sequences, their lengths, where they start in the sequences the caller was given and where to send the edit script.
+ *
+ * Output:
+ *	Emits a shortest edit script turning x into y.
+ *
+ * Side Effects:
+ *	Allocates an (M+1)x(N+1) table, so this is the reference engine and only suited to short lines.
+ *
+ * Notes:
+ *	C[i][j] is the length of the LCS of x[i..M) and y[j..N), so the script can be read off from the front.
+ *	Ties go to the first file: a character of x is deleted as early as any longest common subsequence allows.
+ *	That is the leftmost path through the table, which is well defined no matter how the table is computed.
+ */
+static void dp_diff_at(const int* x, int M, const int* y, int N, int x_base, int y_base, edit_sink* sink)
+{
+	int i, j;
+	//One block for the whole table, C points at rows of N+1 cells
+	int (*C)[N+1] = malloc((size_t) (M+1) * sizeof(*C));
 
-	if(argc >= 3)
+	if(C == NULL)
 	{
-			//Read our two files to get their contents
-			sequence_x = get_file_contents(argv[1],  &sequence_x_length);
-			sequence_y = get_file_contents(argv[2], &sequence_y_length);
+		puts("Memory allocation error.  Program will stop.");
+		exit (1);
 	}
-	else
+
+	for(i = 0; i <= M; i++)
+		C[i][N]=0;
+	for(j = 0; j <= N; j++)
+		C[M][j]=0;
+
+	/*
+	 * This is the LCS algorithm.
+	 * The goal of the algorithm is to find the longest common sequence of our two sequences
+	 * If the characters at the indices are equal, we should add one to the length of our longest sequence found so far
+	 * Otherwise we should use the largest  value from our previous sub-problem.
+	 *
+	 * The length of the LCS is at C[0][0].
+	 */
+	for(i = M - 1; i >= 0; i--)
 	{
-			//We need a minimum of two command line arguments
-			puts("Invalid arguments. Arguments at minimum must include two files.  Please try again.");
-			exit(0);
+		for(j = N - 1; j >= 0; j--)
+		{
+			if(x[i] == y[j])
+			{
+				C[i][j] = C[i+1][j+1] + 1;
+			}
+			else
+			{
+				C[i][j] = max(C[i+1][j], C[i][j+1]);
+			}
+		}
 	}
 
-	//Check for our optional flag, if present, set our switch.
-	if(argc > 3)
+	//Walk the table, each step keeps the LCS of what is left the same
+	i = 0, j = 0;
+	while(i < M || j < N)
 	{
-		if(strcmp(argv[3], "--show-all-lines") == 0)
+		if(i < M && C[i+1][j] == C[i][j])
 		{
-			show_all_lines = 1;
+			sink->emit(sink->context, EDIT_DELETE, x_base + i, y_base + j, 1);
+			i++;
+		}
+		else if(i < M && j < N && x[i] == y[j])
+		{
+			sink->emit(sink->context, EDIT_COMMON, x_base + i, y_base + j, 1);
+			i++;
+			j++;
+		}
+		else
+		{
+			sink->emit(sink->context, EDIT_INSERT, x_base + i, y_base + j, 1);
+			j++;
 		}
 	}
 
+	//Free our matrix
+	free(C);
+}
 
-	//This is the heart of the algorithm
-	//What it does is to create a dynamic programming solution table to the LCS problem.
-	//Once that is finished, we simply read the table back out to find the differences
-	while( x_done < 1 && y_done < 1)
-	{
+/*
+ * Name:
+ *	void dp_diff(const int* x, int M, const int* y, int N, edit_sink* sink)
+ *
+ * Input:
+ *	The two sequences, their lengths and where to send the edit script.
+ *
+ * Output:
+ *	Emits a shortest edit script turning x into y, read off the full table as dp_diff_at describes.
+ *
+ * Side Effects:
+ *	N/A
+ *
+ */
+void dp_diff(const int* x, int M, const int* y, int N, edit_sink* sink)
+{
+	dp_diff_at(x, M, y, N, 0, 0, sink);
+}
+
+/*
+ * Name:
+ *	static int myers_split(const int* x, int M, const int* y, int N, int* forward, int* backward, int* split_x, int* split_y)
+ *
+ * Input:
+ *	The two sequences, their lengths and two scratch arrays of at least M + N + 2 entries each.
+ *
+ * Output:
+ *	Returns 1 and sets (split_x, split_y) to a point in the middle of a shortest edit path.
+ *	Returns 0 if x and y have nothing in common.
+ *
+ * Side Effects:
+ *	N/A
+ *
+ * Notes:
+ *	forward[k] is how far along x the furthest path with d edits gets on diagonal k = i - j.
+ *	backward[k] is the same for paths coming back from (M, N), measured from that corner.
+ *	Once the two frontiers cross on a diagonal, the crossing point lies on a shortest path.
+ *	Diagonals that have run off the edit graph are dropped from the search.
+ */
+static int myers_split(const int* x, int M, const int* y, int N, int* forward, int* backward, int* split_x, int* split_y)
+{
+	int limit = (M + N + 1) / 2;
+	int delta = M - N;
+	//With an odd delta the frontiers meet while searching forwards, with an even one while searching backwards
+	int front = (delta % 2 != 0);
+	int forward_start = 0, forward_end = 0, backward_start = 0, backward_end = 0;
+	int d, k, i, j, other;
 
-			//Clear our line buffer each iteration
-			memset(x_line, 0, sizeof(x_line));
+	for(k = 0; k <= 2 * limit + 1; k++)
+	{
+		forward[k] = -1;
+		backward[k] = -1;
+	}
+	//Offset the arrays so they can be indexed by diagonal
+	forward += limit;
+	backward += limit;
+	forward[1] = 0;
+	backward[1] = 0;
 
-			//If we can read a full line
-			if(x_idx + LINE_SIZE < sequence_x_length)
-			{
-				//Copy the line and update our index variables
-				strncpy(x_line, &sequence_x[x_idx], LINE_SIZE);
-				x_idx = x_idx + LINE_SIZE;
-				x_line_length = LINE_SIZE;
-			}
+	for(d = 0; d < limit; d++)
+	{
+		for(k = -d + forward_start; k <= d - forward_end; k += 2)
+		{
+			if(k == -d || (k != d && forward[k - 1] < forward[k + 1]))
+				i = forward[k + 1];
 			else
+				i = forward[k - 1] + 1;
+			j = i - k;
+			while(i < M && j < N && x[i] == y[j])
 			{
-				//Since we cant read a full line, read as much as is left
-				strncpy(x_line, &sequence_x[x_idx], sequence_x_length - x_idx );
-				x_line_length = sequence_x_length - x_idx;
-				x_idx = x_idx + (sequence_x_length - x_idx);
-				x_done = 1;
+				i++;
+				j++;
 			}
+			forward[k] = i;
 
-			//This code is the same as the above code but for our second input file
-			memset(y_line, 0, sizeof(y_line));
-			if(y_idx + LINE_SIZE < sequence_y_length)
+			if(i > M)
+				forward_end += 2;
+			else if(j > N)
+				forward_start += 2;
+			else if(front)
 			{
-				strncpy(y_line, &sequence_y[y_idx], LINE_SIZE);
-				y_line_length = LINE_SIZE;
-				y_idx = y_idx + LINE_SIZE;
+				other = delta - k;
+				if(other >= -limit && other <= limit && backward[other] != -1 && i >= M - backward[other])
+				{
+					*split_x = i;
+					*split_y = j;
+					return 1;
+				}
 			}
+		}
+
+		for(k = -d + backward_start; k <= d - backward_end; k += 2)
+		{
+			if(k == -d || (k != d && backward[k - 1] < backward[k + 1]))
+				i = backward[k + 1];
 			else
+				i = backward[k - 1] + 1;
+			j = i - k;
+			while(i < M && j < N && x[M - i - 1] == y[N - j - 1])
 			{
-				strncpy(y_line, &sequence_y[y_idx], sequence_y_length - y_idx );
-				y_line_length = sequence_y_length - y_idx;
-				y_idx = y_idx + (sequence_y_length - y_idx);
-				y_done = 1;
+				i++;
+				j++;
 			}
+			backward[k] = i;
 
-			if(show_all_lines < 1)
+			if(i > M)
+				backward_end += 2;
+			else if(j > N)
+				backward_start += 2;
+			else if(!front)
 			{
-				if(strncmp(x_line, y_line, LINE_SIZE+1) == 0)
+				other = delta - k;
+				if(other >= -limit && other <= limit && forward[other] != -1 && forward[other] >= M - i)
 				{
-					continue;
+					*split_x = forward[other];
+					*split_y = forward[other] - other;
+					return 1;
 				}
 			}
+		}
+	}
+	return 0;
+}
 
+/*
+ * Name:
+ *	static void myers_recurse(const int* x, int M, const int* y, int N, int x_base, int y_base, int* forward, int* backward, edit_sink* sink)
+ *
+ * Input:
+ *	The two sequences, their lengths, where they start in the sequences the caller was given, the scratch arrays and the sink.
+ *
+ * Output:
+ *	Emits a shortest edit script for x and y.
+ *
+ * Side Effects:
+ *	N/A
+ *
+ */
+static void myers_recurse(const int* x, int M, const int* y, int N, int x_base, int y_base, int* forward, int* backward, edit_sink* sink)
+{
+	int prefix = 0;
+	int suffix = 0;
+	int split_x, split_y;
 
-			//M and N are sizes used to create our MxN solutions table
-			M = x_line_length;
-			N = y_line_length;
+	//Matching ends are common whatever is in between, so they are peeled off before searching
+	while(prefix < M && prefix < N && x[prefix] == y[prefix])
+		prefix++;
+	if(prefix > 0)
+		sink->emit(sink->context, EDIT_COMMON, x_base, y_base, prefix);
+	while(suffix < M - prefix && suffix < N - prefix && x[M - suffix - 1] == y[N - suffix - 1])
+		suffix++;
 
-		
-			//Allocate memory for our sub-problem solutions table
-			C = malloc((M+1) * sizeof(int *));
-			for(i = 0; i <= M; i++)
-			{
-				C[i] = malloc((N+1)* sizeof(int));
-			}
+	x += prefix;
+	y += prefix;
+	x_base += prefix;
+	y_base += prefix;
+	M -= prefix + suffix;
+	N -= prefix + suffix;
 
-			for(i = 1; i <= M; i++)
-				C[i][0]=0;
-			for(j=0; j <=N; j++)
-				C[0][j]=0;
+	if(M == 0 && N > 0)
+		sink->emit(sink->context, EDIT_INSERT, x_base, y_base, N);
+	else if(N == 0 && M > 0)
+		sink->emit(sink->context, EDIT_DELETE, x_base, y_base, M);
+	else if(M > 0 && N > 0)
+	{
+		if(myers_split(x, M, y, N, forward, backward, &split_x, &split_y))
+		{
+			myers_recurse(x, split_x, y, split_y, x_base, y_base, forward, backward, sink);
+			myers_recurse(x + split_x, M - split_x, y + split_y, N - split_y, x_base + split_x, y_base + split_y, forward, backward, sink);
+		}
+		else
+		{
+			sink->emit(sink->context, EDIT_DELETE, x_base, y_base, M);
+			sink->emit(sink->context, EDIT_INSERT, x_base + M, y_base, N);
+		}
+	}
 
-			/*
-			 * This is the LCS algorithm.
-			 * The goal of the algorithm is to find the longest common sequence of our two sequences
-			 * If the characters at the indices are equal, we should add one to the length of our longest sequence found so far
-			 * Otherwise we should use the largest  value from our previous sub-problem.
- 			 * 
-			 * The length of the LCS is at C[M][N].
-			 *
-			 * 
-			 */
-			for(i = 1; i <= M;  i++)
-			{
-				for(j = 1; j<= N; j++)
-				{
-					if(x_line[i] == y_line[j])
-					{
-						C[i][j] = C[i-1][j-1] + 1;
-					}
-					else
-					{
-						C[i][j] = max(C[i-1][j], C[i][j-1]);
-					}
-				}
-			}
+	if(suffix > 0)
+		sink->emit(sink->context, EDIT_COMMON, x_base + M, y_base + N, suffix);
+}
 
-			/*
-			 *
-			 * This is interesting.  In most cases we don't care about seeing the merged contents.
-			 * So as soon as we find a difference, break out of this and just display the lines for comparison
-			 *
-			 * Now if the user has included the --show-all-lines option, then we should show the merged result and not break out early. 
-			 * We can use the LCS lengths we chose to then determine how and which characters differed from our texts.
-			 *
-			 */
-			i = 0, j = 0;
-			while(i < M && j < N)
-			{
-				//Our characters are equal, don't print them unless we are displaying the merged version
-				if(x_line[i] == y_line[j])
-				{
-					if(show_all_lines > 0)
-					{
-						printf("%c", x_line[i]);
-					}
-					i++;
-					j++;
-				}
-				else{
-				//Our first file contains a difference from our second, break now that we know the lines have a diff
-				//If we are showing the merged contents, display and continue in our loop
-				if(C[i-1][j] >= C[i][j-1])
-				{
-					if(show_all_lines > 0)
-						printf("(>%c)", x_line[i++]);
-					else
-					{
-						++diff_count;
-						break;
-					}
-				}
-				//File2 is different as well.
-				//Break if not showing all lines, otherwise display the character and continue on in this loop.
-				if(C[i-1][j] <=C[i][j-1])
-				{
-					if(show_all_lines > 0)
-							printf("(<%c)", y_line[j++]);
-					else
-					{
-						++diff_count;
-						break;
-					}
-				}
-				}
-			}
+/*
+ * Name:
+ *	void myers_diff(const int* x, int M, const int* y, int N, edit_sink* sink)
+ *
+ * Input:
+ *	The two sequences, their lengths and where to send the edit script.
+ *
+ * Output:
+ *	Emits a shortest edit script turning x into y.
+ *
+ * Side Effects:
+ *	N/A
+ *
+ * Notes:
+ *	This is the linear space refinement from section 4b of Myers' paper.  Rather than keeping every frontier to trace the path back,
+ *	each level finds one point in the middle of a shortest path and recurses on both sides of it.
+ *	The time is O((M+N)D) and the memory O(M+N), whatever the recursion depth.
+ */
+void myers_diff(const int* x, int M, const int* y, int N, edit_sink* sink)
+{
+	//Every sub-problem is smaller than the whole, so one pair of arrays serves the entire recursion
+	int size = M + N + 4;
+	int* forward = malloc(sizeof(int) * size);
+	int* backward = malloc(sizeof(int) * size);
 
-			//We may need to take care of leftover differences if one was shorter than the other, do that here.
-			if(show_all_lines > 0)
-			{
-			while(i < M || j < N)
-			{
-				if(i == M)
-				{
-					printf("(<%c)", y_line[j++]);
-				}
-				else if(j == N)
-				{
-					printf("(>%c)", x_line[i++]);
-				}
-			}
-			}
+	if(forward == NULL || backward == NULL)
+	{
+		puts("Memory allocation error.  Program will stop.");
+		exit (1);
+	}
+	myers_recurse(x, M, y, N, 0, 0, forward, backward, sink);
+	free(forward);
+	free(backward);
+}
 
-			//If we are not showing the merged files, just display the lines aligned as diff does
-			//This will allow the user to easiily see how the files differed.
-			if(show_all_lines == 0)
-			{
-				if(diff_count > 0)
-				{
-					printf("Difference located at starting at %s:%d-%d and %s:%d-%d:\r\n", argv[1],  x_idx-x_line_length, x_idx, argv[2], y_idx-y_line_length, y_idx);
-					printf("< %s | \r\n> %s", x_line, y_line);
-					diff_count = 0;
-				}
+/*
+ * Bit-parallel LCS length, after Allison and Dix (1986) and Hyyro ("Bit-parallel LCS-length computation revisited", 2004).
+ *
+ * A row of the LCS table only ever steps up by 0 or 1 from one column to the next, so a whole row fits in one bit per column.
+ * Bit i of V is 0 where the row steps up at column i, and the LCS of the columns so far is the number of 0 bits.
+ * Moving down a row for symbol c is then V = (V + (V & PM[c])) | (V & ~PM[c]), where PM[c] has a 1 at every column holding c.
+ * That updates 64 columns per word, with only the carry of the addition running from one word to the next.
+ *
+ * The portable loop does one word at a time.  The AVX2 and AVX-512 loops add 4 or 8 words at once and then settle the carries
+ * between them with a few bit operations on the lane masks, so the carry chain costs one step per vector rather than per word.
+ */
 
-				printf("\r\n\r\n");
-			}
+static int count_ones(uint64_t word)
+{
+#ifdef __GNUC__
+	return __builtin_popcountll(word);
+#else
+	int count = 0;
+	for(; word != 0; word &= word - 1)
+		count++;
+	return count;
+#endif
+}
 
-			
-			//Free our matrix items
-			for (i = 0; i <= M; i++) {
-				    free(C[i]);
-			}
-			free(C);
+/*
+ * Turns the rows of the second sequence into updates of V, one loop per instruction set.
+ * carry_in and carry_out hold a bit per row when they are not NULL.  carry_in is what row r steps up by down the column
+ * left of V, which is 0 for the left edge of the table, and it goes in as the carry of the addition.  carry_out gets the
+ * carry out of the last word, which is the step down the column right of V when V is a whole number of words, and must start zeroed.
+ */
+typedef void (*bit_lcs_rows_fn)(uint64_t* V, const uint64_t* masks, int words, int alphabet, const int* y, int N, const uint64_t* carry_in, uint64_t* carry_out);
+
+/*
+ * Name:
+ *	static void bit_lcs_rows_portable(uint64_t* V, const uint64_t* masks, int words, int alphabet, const int* y, int N, const uint64_t* carry_in, uint64_t* carry_out)
+ *
+ * Input:
+ *	The row bits, the match masks (words per symbol for symbols below alphabet, then a row of zeros),
+ *	the sequence going down the rows and the carry bits described at bit_lcs_rows_fn.
+ *
+ * Output:
+ *	N/A
+ *
+ * Side Effects:
+ *	Updates V to the last row.
+ *
+ */
+static void bit_lcs_rows_portable(uint64_t* V, const uint64_t* masks, int words, int alphabet, const int* y, int N, const uint64_t* carry_in, uint64_t* carry_out)
+{
+	int r, w;
+	const uint64_t* pm;
+	uint64_t v, u, s, carry;
 
+	for(r = 0; r < N; r++)
+	{
+		carry = carry_in != NULL ? (carry_in[r / 64] >> (r % 64)) & 1 : 0;
+		//A symbol the columns never hold leaves the row as it is, unless a carry comes in
+		if(y[r] >= alphabet && carry == 0)
+			continue;
+		pm = masks + (size_t) (y[r] < alphabet ? y[r] : alphabet) * words;
+		for(w = 0; w < words; w++)
+		{
+			v = V[w];
+			u = v & pm[w];
+			s = v + u + carry;
+			//The sum wrapped if it is below v, or equal to it with a carry in and u all ones
+			carry = (s < v) | ((s == v) & (uint64_t) (carry != 0));
+			V[w] = s | (v & ~pm[w]);
+		}
+		if(carry_out != NULL)
+			carry_out[r / 64] |= carry << (r % 64);
 	}
-	//Clean up memory and end
-	free(sequence_x);
-	free(sequence_y);
-	printf("\r\n");
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define BIT_LCS_X86 1
+
+/*
+ * Name:
+ *	static void bit_lcs_rows_avx2(uint64_t* V, const uint64_t* masks, int words, int alphabet, const int* y, int N, const uint64_t* carry_in, uint64_t* carry_out)
+ *
+ * Input:
+ *	As bit_lcs_rows_portable
+ *
+ * Output:
+ *	N/A
+ *
+ * Side Effects:
+ *	Updates V to the last row.
+ *
+ * Notes:
+ *	Each lane adds on its own first.  A lane that overflowed generates a carry into the next one, and a lane that came out
+ *	all ones passes on any carry it gets.  Adding the propagate mask to the shifted generate mask works out every lane's carry
+ *	in at once, just as the carry of an ordinary addition runs through a string of 1 bits, and the lanes that get one add 1.
+ */
+__attribute__((target("avx2")))
+static void bit_lcs_rows_avx2(uint64_t* V, const uint64_t* masks, int words, int alphabet, const int* y, int N, const uint64_t* carry_in, uint64_t* carry_out)
+{
+	const __m256i ones = _mm256_set1_epi64x(-1);
+	//AVX2 only compares signed, flipping the top bits turns that into an unsigned compare
+	const __m256i flip = _mm256_set1_epi64x((long long) 0x8000000000000000ULL);
+	const __m256i lanes = _mm256_set_epi64x(8, 4, 2, 1);
+	int r, w;
+	const uint64_t* pm;
+	unsigned carry, generate, propagate, sum, into;
+	__m256i v, p, s, add;
+	uint64_t sv, su, ss, sc;
+
+	for(r = 0; r < N; r++)
+	{
+		carry = carry_in != NULL ? (carry_in[r / 64] >> (r % 64)) & 1 : 0;
+		if(y[r] >= alphabet && carry == 0)
+			continue;
+		pm = masks + (size_t) (y[r] < alphabet ? y[r] : alphabet) * words;
+		for(w = 0; w + 4 <= words; w += 4)
+		{
+			v = _mm256_loadu_si256((const __m256i*) (V + w));
+			p = _mm256_loadu_si256((const __m256i*) (pm + w));
+			s = _mm256_add_epi64(v, _mm256_and_si256(v, p));
+			generate = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(_mm256_xor_si256(v, flip), _mm256_xor_si256(s, flip))));
+			propagate = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(s, ones)));
+			sum = ((generate << 1) | carry) + propagate;
+			into = (sum ^ propagate) & 0xF;
+			carry = (sum >> 4) & 1;
+			//Lanes getting a carry subtract -1
+			add = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(into), lanes), lanes);
+			s = _mm256_sub_epi64(s, add);
+			_mm256_storeu_si256((__m256i*) (V + w), _mm256_or_si256(s, _mm256_andnot_si256(p, v)));
+		}
+		sc = carry;
+		for(; w < words; w++)
+		{
+			sv = V[w];
+			su = sv & pm[w];
+			ss = sv + su + sc;
+			sc = (ss < sv) | ((ss == sv) & (uint64_t) (sc != 0));
+			V[w] = ss | (sv & ~pm[w]);
+		}
+		if(carry_out != NULL)
+			carry_out[r / 64] |= sc << (r % 64);
+	}
+}
+
+/*
+ * Name:
+ *	static void bit_lcs_rows_avx512(uint64_t* V, const uint64_t* masks, int words, int alphabet, const int* y, int N, const uint64_t* carry_in, uint64_t* carry_out)
+ *
+ * Input:
+ *	As bit_lcs_rows_portable
+ *
+ * Output:
+ *	N/A
+ *
+ * Side Effects:
+ *	Updates V to the last row.
+ *
+ * Notes:
+ *	The same carry settling as bit_lcs_rows_avx2 on 8 lanes.  The compares give lane masks directly and the
+ *	final combine is a single ternary logic instruction.
+ */
+__attribute__((target("avx512f")))
+static void bit_lcs_rows_avx512(uint64_t* V, const uint64_t* masks, int words, int alphabet, const int* y, int N, const uint64_t* carry_in, uint64_t* carry_out)
+{
+	const __m512i ones = _mm512_set1_epi64(-1);
+	int r, w;
+	const uint64_t* pm;
+	unsigned carry, generate, propagate, sum, into;
+	__m512i v, p, s;
+	uint64_t sv, su, ss, sc;
+
+	for(r = 0; r < N; r++)
+	{
+		carry = carry_in != NULL ? (carry_in[r / 64] >> (r % 64)) & 1 : 0;
+		if(y[r] >= alphabet && carry == 0)
+			continue;
+		pm = masks + (size_t) (y[r] < alphabet ? y[r] : alphabet) * words;
+		for(w = 0; w + 8 <= words; w += 8)
+		{
+			v = _mm512_loadu_si512(V + w);
+			p = _mm512_loadu_si512(pm + w);
+			s = _mm512_add_epi64(v, _mm512_and_si512(v, p));
+			generate = _mm512_cmplt_epu64_mask(s, v);
+			propagate = _mm512_cmpeq_epi64_mask(s, ones);
+			sum = ((generate << 1) | carry) + propagate;
+			into = (sum ^ propagate) & 0xFF;
+			carry = (sum >> 8) & 1;
+			s = _mm512_mask_sub_epi64(s, (__mmask8) into, s, ones);
+			//s | (v & ~p)
+			_mm512_storeu_si512(V + w, _mm512_ternarylogic_epi64(s, v, p, 0xF4));
+		}
+		sc = carry;
+		for(; w < words; w++)
+		{
+			sv = V[w];
+			su = sv & pm[w];
+			ss = sv + su + sc;
+			sc = (ss < sv) | ((ss == sv) & (uint64_t) (sc != 0));
+			V[w] = ss | (sv & ~pm[w]);
+		}
+		if(carry_out != NULL)
+			carry_out[r / 64] |= sc << (r % 64);
+	}
+}
+#endif
+
+/*
+ * Name:
+ *	bit_lcs_rows_fn bit_lcs_rows(void)
+ *
+ * Input:
+ *	N/A
+ *
+ * Output:
+ *	Returns the widest row loop this processor runs.  Setting LCS_SIMD to avx512, avx2 or portable in the environment picks one.
+ *
+ * Side Effects:
+ *	N/A
+ *
+ */
+bit_lcs_rows_fn bit_lcs_rows(void)
+{
+	const char* choice = getenv("LCS_SIMD");
+
+	if(choice != NULL && strcmp(choice, "portable") == 0)
+		return bit_lcs_rows_portable;
+#ifdef BIT_LCS_X86
+	__builtin_cpu_init();
+	if((choice == NULL || strcmp(choice, "avx512") == 0) && __builtin_cpu_supports("avx512f"))
+		return bit_lcs_rows_avx512;
+	if((choice == NULL || strcmp(choice, "avx512") != 0) && __builtin_cpu_supports("avx2"))
+		return bit_lcs_rows_avx2;
+#endif
+	return bit_lcs_rows_portable;
+}
+
+/*
+ * Name:
+ *	static uint64_t* bit_lcs_bits(const int* x, int M, int alphabet, const int* y, int N)
+ *
+ * Input:
+ *	The sequence going across and its length, one more than its largest symbol, and the sequence going down the rows.
+ *
+ * Output:
+ *	Returns the ceil(M/64) words of V for the last row.  Bit k is 0 where LCS(x[0..k], y) is one more than LCS(x[0..k), y).
+ *
+ * Side Effects:
+ *	The caller is responsible for freeing the words.
+ *
+ */
+static uint64_t* bit_lcs_bits(const int* x, int M, int alphabet, const int* y, int N)
+{
+	static bit_lcs_rows_fn rows = NULL;
+	int words = (M + 63) / 64;
+	int i, w;
+	uint64_t* V = malloc(sizeof(uint64_t) * (words > 0 ? words : 1));
+	uint64_t* masks = calloc((size_t) (alphabet + 1) * words + 1, sizeof(uint64_t));
+
+	if(V == NULL || masks == NULL)
+	{
+		puts("Memory allocation error.  Program will stop.");
+		exit (1);
+	}
+	if(rows == NULL)
+		rows = bit_lcs_rows();
+
+	for(i = 0; i < M; i++)
+		masks[(size_t) x[i] * words + i / 64] |= (uint64_t) 1 << (i % 64);
+	for(w = 0; w < words; w++)
+		V[w] = ~(uint64_t) 0;
+
+	rows(V, masks, words, alphabet, y, N, NULL, NULL);
+	free(masks);
+	return V;
+}
+
+/*
+ * Name:
+ *	int bit_lcs_length(const int* x, int M, const int* y, int N)
+ *
+ * Input:
+ *	The two sequences and their lengths.  Symbols must not be negative.
+ *
+ * Output:
+ *	Returns the length of the longest common subsequence of x and y, in O(MN/64) time.
+ *
+ * Side Effects:
+ *	Allocates a match mask of ceil(min(M,N)/64) words for every symbol up to the largest one in the shorter sequence,
+ *	so this is meant for small alphabets such as bytes.
+ *
+ */
+int bit_lcs_length(const int* x, int M, const int* y, int N)
+{
+	const int* t;
+	int words, alphabet, i, w, length;
+	uint64_t* V;
+
+	//The LCS is symmetric, the shorter sequence goes across so the masks stay small
+	if(M > N)
+	{
+		t = x, x = y, y = t;
+		i = M, M = N, N = i;
+	}
+	if(M == 0)
+		return 0;
+
+	words = (M + 63) / 64;
+	alphabet = 0;
+	for(i = 0; i < M; i++)
+		alphabet = max(alphabet, x[i] + 1);
+	V = bit_lcs_bits(x, M, alphabet, y, N);
+
+	//Count the 0 bits, the ones past column M never change
+	length = 0;
+	for(w = 0; w < words; w++)
+		length += 64 - count_ones(V[w]);
+
+	free(V);
+	return length;
+}
+
+/*
+ * Name:
+ *	void lcs_row(const int* x, int M, const int* y, int N, int* row)
+ *
+ * Input:
+ *	The two sequences, their lengths and N + 1 ints for the result.
+ *
+ * Output:
+ *	Sets row[k] to the length of the LCS of x and y[0..k), for every k from 0 to N.  This is the last row of the LCS table.
+ *
+ * Side Effects:
+ *	N/A
+ *
+ * Notes:
+ *	Uses the bit-parallel kernel with y going across while its match masks stay within a few words per column, as they do for bytes.
+ *	Larger alphabets go through the table a row at a time.  Either way the memory is O(N).
+ */
+void lcs_row(const int* x, int M, const int* y, int N, int* row)
+{
+	int alphabet = 0;
+	int words = (N + 63) / 64;
+	int i, k;
+	int* previous;
+	uint64_t* V;
+
+	for(k = 0; k < N; k++)
+		alphabet = max(alphabet, y[k] + 1);
+
+	row[0] = 0;
+	if((size_t) alphabet * words <= 8 * (size_t) (N + 64))
+	{
+		V = bit_lcs_bits(y, N, alphabet, x, M);
+		for(k = 0; k < N; k++)
+			row[k + 1] = row[k] + (int) (~V[k / 64] >> (k % 64) & 1);
+		free(V);
+		return;
+	}
+
+	previous = malloc(sizeof(int) * (N + 1));
+	if(previous == NULL)
+	{
+		puts("Memory allocation error.  Program will stop.");
+		exit (1);
+	}
+	for(k = 0; k <= N; k++)
+		row[k] = 0;
+	for(i = 0; i < M; i++)
+	{
+		memcpy(previous, row, sizeof(int) * (N + 1));
+		for(k = 0; k < N; k++)
+		{
+			if(x[i] == y[k])
+				row[k + 1] = previous[k] + 1;
+			else
+				row[k + 1] = max(previous[k + 1], row[k]);
+		}
+	}
+	free(previous);
+}
+
+/*
+ * Name:
+ *	static int* reversed_copy(const int* s, int length)
+ *
+ * Input:
+ *	A sequence and its length
+ *
+ * Output:
+ *	Returns a copy of the sequence back to front.
+ *
+ * Side Effects:
+ *	The caller is responsible for freeing the copy.
+ *
+ */
+static int* reversed_copy(const int* s, int length)
+{
+	int* copy = malloc(sizeof(int) * (length > 0 ? length : 1));
+	int i;
+
+	if(copy == NULL)
+	{
+		puts("Memory allocation error.  Program will stop.");
+		exit (1);
+	}
+	for(i = 0; i < length; i++)
+		copy[i] = s[length - 1 - i];
+	return copy;
+}
+
+/*
+ * Name:
+ *	static void hirschberg_recurse(const int* x, int M, const int* y, int N, int x_base, int y_base, edit_sink* sink)
+ *
+ * Input:
+ *	The two sequences, their lengths, where they start in the sequences the caller was given and the sink.
+ *
+ * Output:
+ *	Emits the same edit script as dp_diff_at.
+ *
+ * Side Effects:
+ *	N/A
+ *
+ * Notes:
+ *	x is cut in half.  The LCS of the top half with every prefix of y and of the bottom half with every suffix of y says
+ *	at which columns an optimal path can cross the middle, and the smallest of them is where the leftmost path, the one
+ *	dp_diff_at reads off its table, crosses.  Both halves are then solved the same way, and small ones with the table itself.
+ */
+static void hirschberg_recurse(const int* x, int M, const int* y, int N, int x_base, int y_base, edit_sink* sink)
+{
+	int mid = M / 2;
+	int best = 0;
+	int k;
+	int* forward;
+	int* backward;
+	int* x_reversed;
+	int* y_reversed;
+
+	if(M <= 1 || (long long) (M + 1) * (N + 1) <= 4096)
+	{
+		dp_diff_at(x, M, y, N, x_base, y_base, sink);
+		return;
+	}
+
+	forward = malloc(sizeof(int) * (N + 1));
+	backward = malloc(sizeof(int) * (N + 1));
+	if(forward == NULL || backward == NULL)
+	{
+		puts("Memory allocation error.  Program will stop.");
+		exit (1);
+	}
+	lcs_row(x, mid, y, N, forward);
+	//backward[N - k] is the LCS of the bottom half with y[k..N)
+	x_reversed = reversed_copy(x + mid, M - mid);
+	y_reversed = reversed_copy(y, N);
+	lcs_row(x_reversed, M - mid, y_reversed, N, backward);
+	free(x_reversed);
+	free(y_reversed);
+
+	for(k = 1; k <= N; k++)
+	{
+		if(forward[k] + backward[N - k] > forward[best] + backward[N - best])
+			best = k;
+	}
+	free(forward);
+	free(backward);
+
+	hirschberg_recurse(x, mid, y, best, x_base, y_base, sink);
+	hirschberg_recurse(x + mid, M - mid, y + best, N - best, x_base + mid, y_base + best, sink);
+}
+
+/*
+ * Name:
+ *	void hirschberg_diff(const int* x, int M, const int* y, int N, edit_sink* sink)
+ *
+ * Input:
+ *	The two sequences, their lengths and where to send the edit script.
+ *
+ * Output:
+ *	Emits the same edit script as dp_diff, character for character.
+ *
+ * Side Effects:
+ *	N/A
+ *
+ * Notes:
+ *	Hirschberg's divide and conquer ("A linear space algorithm for computing maximal common subsequences", 1975).
+ *	The memory is O(M+N) rather than the O(MN) of the table, and the time stays O(MN), a factor of 64 or so less with the bit-parallel rows.
+ */
+void hirschberg_diff(const int* x, int M, const int* y, int N, edit_sink* sink)
+{
+	hirschberg_recurse(x, M, y, N, 0, 0, sink);
+}
+
+/*
+ * Tiled wavefront LCS for aligning whole files on every core.
+ *
+ * The table is filled backwards, as the LCS of the reversed sequences, so it holds the suffix lengths dp_diff_at walks.
+ * It is cut into tiles of whole words across.  A tile needs only the bits of the row along its top, which the tile above
+ * leaves behind, and the steps down the column along its left, which the tile to its left leaves behind.  Tiles on the
+ * same anti-diagonal are independent and run in parallel on a pool of threads, each through the bit-parallel row loop.
+ * Only those boundaries are kept, a bit per cell along every tile edge, rather than the table.
+ *
+ * The path is then read off as dp_diff_at does.  Each tile it passes through is filled again from its edges, this time
+ * keeping the step down at every cell, which is all dp_diff_at's rule needs to choose a move.
+ */
+
+//Threads for --algorithm=wavefront, 0 for one per processor
+int wavefront_threads = 0;
+
+typedef struct wavefront
+{
+	//The reversed sequences, a going down the rows and b across
+	const int* a;
+	int M;
+	const int* b;
+	int N;
+	int alphabet;
+
+	//Tiles are tile_rows by tile_columns, both multiples of 64
+	int tile_rows;
+	int tile_columns;
+	int row_blocks;
+	int column_blocks;
+
+	//row_words of V for the top of each row block, and column_words of steps down the left of each column block
+	int row_words;
+	int column_words;
+	uint64_t* top;
+	uint64_t* left;
+
+	//Tiles whose neighbours above and to the left are done wait in the queue
+	pthread_mutex_t lock;
+	pthread_cond_t ready;
+	int* waiting;
+	int* queue;
+	int head;
+	int tail;
+	int taken;
+	bit_lcs_rows_fn rows;
+} wavefront;
+
+//What one thread needs to fill a tile
+typedef struct tile_scratch
+{
+	//min(alphabet, tile_columns) + 1 rows of ceil(tile_columns / 64) words, the last row never set
+	uint64_t* masks;
+	//One plus the local symbol of each symbol of b in the current tile, 0 for the rest.
+	//NULL when the alphabet is no larger than a tile is wide, then symbols are their own local symbols.
+	int* code;
+	//The tile's rows of a in local symbols, local holds them when they are renumbered
+	const int* rows;
+	int* local;
+	uint64_t* V;
+} tile_scratch;
+
+static void tile_scratch_init(const wavefront* w, tile_scratch* t)
+{
+	int words = (w->tile_columns + 63) / 64;
+
+	t->masks = calloc((size_t) (min(w->alphabet, w->tile_columns) + 1) * words, sizeof(uint64_t));
+	t->code = NULL;
+	t->local = NULL;
+	if(w->alphabet > w->tile_columns)
+	{
+		t->code = calloc(w->alphabet, sizeof(int));
+		t->local = malloc(sizeof(int) * w->tile_rows);
+	}
+	t->V = malloc(sizeof(uint64_t) * words);
+	if(t->masks == NULL || (w->alphabet > w->tile_columns && (t->code == NULL || t->local == NULL)) || t->V == NULL)
+	{
+		puts("Memory allocation error.  Program will stop.");
+		exit (1);
+	}
+}
+
+static void tile_scratch_free(tile_scratch* t)
+{
+	free(t->masks);
+	free(t->code);
+	free(t->local);
+	free(t->V);
+}
+
+/*
+ * Name:
+ *	static int tile_masks(const wavefront* w, int row, int height, int column, int width, tile_scratch* t)
+ *
+ * Input:
+ *	The wavefront, the first row and column of a tile and its size, and scratch space whose masks and codes are clear.
+ *
+ * Output:
+ *	Returns the size of the tile's local alphabet, fills in the match masks of its columns and points rows at the tile's
+ *	rows of a in local symbols.  A symbol at or past the size of the local alphabet selects the all zero row.
+ *	clear_tile_masks clears the scratch space again.
+ *
+ * Side Effects:
+ *	N/A
+ *
+ * Notes:
+ *	With lines as symbols the alphabet can be as large as the files, but a tile only ever holds tile_columns of them.
+ *	Then the symbols of the columns are numbered from 0 in the order they first appear and the rows are renumbered to
+ *	match, so the masks stay a bit per cell of a square tile at most instead of a bit per column for every line.
+ *	A small alphabet, as for characters, is used as it is.
+ */
+static int tile_masks(const wavefront* w, int row, int height, int column, int width, tile_scratch* t)
+{
+	int words = (width + 63) / 64;
+	int symbols = 0;
+	int k, symbol;
+
+	if(t->code == NULL)
+	{
+		for(k = 0; k < width; k++)
+			t->masks[(size_t) w->b[column + k] * words + k / 64] |= (uint64_t) 1 << (k % 64);
+		t->rows = w->a + row;
+		return w->alphabet;
+	}
+
+	for(k = 0; k < width; k++)
+	{
+		symbol = w->b[column + k];
+		if(t->code[symbol] == 0)
+			t->code[symbol] = ++symbols;
+		t->masks[(size_t) (t->code[symbol] - 1) * words + k / 64] |= (uint64_t) 1 << (k % 64);
+	}
+	for(k = 0; k < height; k++)
+	{
+		symbol = w->a[row + k];
+		t->local[k] = symbol < w->alphabet && t->code[symbol] != 0 ? t->code[symbol] - 1 : symbols;
+	}
+	t->rows = t->local;
+	return symbols;
+}
+
+static void clear_tile_masks(const wavefront* w, int column, int width, tile_scratch* t)
+{
+	int words = (width + 63) / 64;
+	int k;
+
+	//Only the words and codes that were set
+	if(t->code == NULL)
+	{
+		for(k = 0; k < width; k++)
+			t->masks[(size_t) w->b[column + k] * words + k / 64] = 0;
+		return;
+	}
+	for(k = 0; k < width; k++)
+		t->masks[(size_t) (t->code[w->b[column + k]] - 1) * words + k / 64] = 0;
+	for(k = 0; k < width; k++)
+		t->code[w->b[column + k]] = 0;
+}
+
+/*
+ * Name:
+ *	static void fill_tile(wavefront* w, int tile, tile_scratch* t)
+ *
+ * Input:
+ *	The wavefront, a tile whose top and left edges are known, and the thread's scratch space.
+ *
+ * Output:
+ *	N/A
+ *
+ * Side Effects:
+ *	Stores the tile's bottom edge as the top of the next row block and its right edge as the left of the next column block.
+ *
+ */
+static void fill_tile(wavefront* w, int tile, tile_scratch* t)
+{
+	int row_block = tile / w->column_blocks;
+	int column_block = tile % w->column_blocks;
+	int row = row_block * w->tile_rows;
+	int column = column_block * w->tile_columns;
+	int height = min(w->tile_rows, w->M - row);
+	int width = min(w->tile_columns, w->N - column);
+	int words = (width + 63) / 64;
+	uint64_t* V = t->V;
+	uint64_t* right = NULL;
+	int symbols;
+
+	memcpy(V, w->top + (size_t) row_block * w->row_words + column / 64, sizeof(uint64_t) * words);
+	if(column_block + 1 < w->column_blocks)
+	{
+		right = w->left + (size_t) (column_block + 1) * w->column_words + row / 64;
+		memset(right, 0, sizeof(uint64_t) * ((height + 63) / 64));
+	}
+
+	symbols = tile_masks(w, row, height, column, width, t);
+	w->rows(V, t->masks, words, symbols, t->rows, height, w->left + (size_t) column_block * w->column_words + row / 64, right);
+	clear_tile_masks(w, column, width, t);
+
+	if(row_block + 1 < w->row_blocks)
+		memcpy(w->top + (size_t) (row_block + 1) * w->row_words + column / 64, V, sizeof(uint64_t) * words);
+}
+
+/*
+ * Name:
+ *	static void* wavefront_worker(void* argument)
+ *
+ * Input:
+ *	The wavefront
+ *
+ * Output:
+ *	Returns NULL once every tile has been taken.
+ *
+ * Side Effects:
+ *	Fills tiles as they become ready and queues the tiles that were waiting on them.
+ *
+ */
+static void* wavefront_worker(void* argument)
+{
+	wavefront* w = argument;
+	int tiles = w->row_blocks * w->column_blocks;
+	tile_scratch t;
+	int tile, next;
+
+	tile_scratch_init(w, &t);
+	for(;;)
+	{
+		pthread_mutex_lock(&w->lock);
+		while(w->head == w->tail && w->taken < tiles)
+			pthread_cond_wait(&w->ready, &w->lock);
+		if(w->taken == tiles)
+		{
+			pthread_mutex_unlock(&w->lock);
+			break;
+		}
+		tile = w->queue[w->head++];
+		//Whoever takes the last tile lets the idle threads go
+		if(++w->taken == tiles)
+			pthread_cond_broadcast(&w->ready);
+		pthread_mutex_unlock(&w->lock);
+
+		fill_tile(w, tile, &t);
+
+		pthread_mutex_lock(&w->lock);
+		//The tile below and the tile to the right
+		next = tile + w->column_blocks;
+		if(next < tiles && --w->waiting[next] == 0)
+			w->queue[w->tail++] = next;
+		next = tile + 1;
+		if(next % w->column_blocks != 0 && --w->waiting[next] == 0)
+			w->queue[w->tail++] = next;
+		pthread_cond_broadcast(&w->ready);
+		pthread_mutex_unlock(&w->lock);
+	}
+
+	tile_scratch_free(&t);
+	return NULL;
+}
+
+/*
+ * Name:
+ *	static void wavefront_fill(wavefront* w, int threads)
+ *
+ * Input:
+ *	The wavefront, with its sequences and tile sizes set, and how many threads to fill it with.
+ *
+ * Output:
+ *	N/A
+ *
+ * Side Effects:
+ *	Allocates and fills the tile edges, wavefront_free releases them.
+ *
+ */
+static void wavefront_fill(wavefront* w, int threads)
+{
+	int tiles, tile, k;
+	pthread_t* pool;
+
+	w->row_blocks = max((w->M + w->tile_rows - 1) / w->tile_rows, 1);
+	w->column_blocks = max((w->N + w->tile_columns - 1) / w->tile_columns, 1);
+	w->row_words = (w->N + 63) / 64 + 1;
+	w->column_words = (w->M + 63) / 64 + 1;
+	tiles = w->row_blocks * w->column_blocks;
+
+	//The top edge of the table is all ones, no steps, and its left edge is all zeros
+	w->top = malloc(sizeof(uint64_t) * w->row_words * w->row_blocks);
+	w->left = calloc((size_t) w->column_words * w->column_blocks, sizeof(uint64_t));
+	w->waiting = malloc(sizeof(int) * tiles);
+	w->queue = malloc(sizeof(int) * tiles);
+	if(w->top == NULL || w->left == NULL || w->waiting == NULL || w->queue == NULL)
+	{
+		puts("Memory allocation error.  Program will stop.");
+		exit (1);
+	}
+	for(k = 0; k < w->row_words; k++)
+		w->top[k] = ~(uint64_t) 0;
+
+	for(tile = 0; tile < tiles; tile++)
+		w->waiting[tile] = (tile >= w->column_blocks) + (tile % w->column_blocks != 0);
+	w->queue[0] = 0;
+	w->head = 0;
+	w->tail = 1;
+	w->taken = 0;
+	w->rows = bit_lcs_rows();
+	pthread_mutex_init(&w->lock, NULL);
+	pthread_cond_init(&w->ready, NULL);
+
+	//No more threads than the widest anti-diagonal has tiles, the calling thread is one of them
+	threads = min(threads, min(w->row_blocks, w->column_blocks));
+	pool = malloc(sizeof(pthread_t) * threads);
+	for(k = 1; k < threads; k++)
+	{
+		if(pthread_create(&pool[k], NULL, wavefront_worker, w) != 0)
+		{
+			puts("Could not start a thread.  Program will stop.");
+			exit (1);
+		}
+	}
+	wavefront_worker(w);
+	for(k = 1; k < threads; k++)
+		pthread_join(pool[k], NULL);
+	free(pool);
+
+	pthread_mutex_destroy(&w->lock);
+	pthread_cond_destroy(&w->ready);
+	free(w->waiting);
+	free(w->queue);
+}
+
+/*
+ * Name:
+ *	static void refill_tile(const wavefront* w, int row_block, int column_block, tile_scratch* t, uint64_t* down)
+ *
+ * Input:
+ *	The filled wavefront, a tile, scratch space and tile_rows * (tile_columns / 64 + 1) words for the result.
+ *
+ * Output:
+ *	Sets bit k of row r of down, rows being tile_columns / 64 + 1 words long, to the step down from the tile's row r to row r + 1
+ *	in its column k, for k from 0 up to and including the tile's width.
+ *
+ * Side Effects:
+ *	N/A
+ *
+ * Notes:
+ *	The steps down are the carries into each bit of the row's addition, and those are the bits of the sum that differ from
+ *	the bits of the two numbers added.  This is the portable row loop keeping them, the path only passes through a few tiles.
+ */
+static void refill_tile(const wavefront* w, int row_block, int column_block, tile_scratch* t, uint64_t* down)
+{
+	int row = row_block * w->tile_rows;
+	int column = column_block * w->tile_columns;
+	int height = min(w->tile_rows, w->M - row);
+	int width = min(w->tile_columns, w->N - column);
+	int words = (width + 63) / 64;
+	int stride = w->tile_columns / 64 + 1;
+	const uint64_t* left = w->left + (size_t) column_block * w->column_words + row / 64;
+	uint64_t* V = t->V;
+	const uint64_t* pm;
+	uint64_t v, u, s, carry;
+	int r, k, symbols;
+
+	memcpy(V, w->top + (size_t) row_block * w->row_words + column / 64, sizeof(uint64_t) * words);
+	symbols = tile_masks(w, row, height, column, width, t);
+	for(r = 0; r < height; r++)
+	{
+		pm = t->masks + (size_t) min(t->rows[r], symbols) * words;
+		carry = (left[r / 64] >> (r % 64)) & 1;
+		for(k = 0; k < words; k++)
+		{
+			v = V[k];
+			u = v & pm[k];
+			s = v + u + carry;
+			down[(size_t) r * stride + k] = s ^ v ^ u;
+			carry = (s < v) | ((s == v) & (uint64_t) (carry != 0));
+			V[k] = s | (v & ~pm[k]);
+		}
+		//The step past a whole number of words is the carry out of the last one
+		down[(size_t) r * stride + words] = carry;
+	}
+	clear_tile_masks(w, column, width, t);
+}
+
+//Collects single steps into runs for a sink
+typedef struct run_builder
+{
+	edit_sink* sink;
+	int op;
+	int x_start;
+	int y_start;
+	int count;
+} run_builder;
+
+static void add_step(run_builder* run, int op, int x_index, int y_index)
+{
+	if(run->count > 0 && run->op == op)
+	{
+		run->count++;
+		return;
+	}
+	if(run->count > 0)
+		run->sink->emit(run->sink->context, run->op, run->x_start, run->y_start, run->count);
+	run->op = op;
+	run->x_start = x_index;
+	run->y_start = y_index;
+	run->count = 1;
+}
+
+/*
+ * Name:
+ *	void wavefront_diff_tiled(const int* x, int M, const int* y, int N, int threads, int tile_rows, int tile_columns, edit_sink* sink)
+ *
+ * Input:
+ *	The two sequences, their lengths, how many threads to fill the table with, the tile size (multiples of 64) and the sink.
+ *
+ * Output:
+ *	Emits the same edit script as dp_diff.
+ *
+ * Side Effects:
+ *	N/A
+ *
+ */
+void wavefront_diff_tiled(const int* x, int M, const int* y, int N, int threads, int tile_rows, int tile_columns, edit_sink* sink)
+{
+	wavefront w;
+	run_builder run;
+	int* a = reversed_copy(x, M);
+	int* b = reversed_copy(y, N);
+	int stride = tile_columns / 64 + 1;
+	tile_scratch t;
+	uint64_t* down = malloc(sizeof(uint64_t) * tile_rows * stride);
+	//The walk in the coordinates of the reversed sequences, i = M - p and j = N - q
+	int p = M;
+	int q = N;
+	int row_block, column_block, row, column, step;
+	int k;
+
+	w.a = a;
+	w.M = M;
+	w.b = b;
+	w.N = N;
+	w.alphabet = 0;
+	for(k = 0; k < N; k++)
+		w.alphabet = max(w.alphabet, b[k] + 1);
+	w.tile_rows = tile_rows;
+	w.tile_columns = tile_columns;
+	if(down == NULL)
+	{
+		puts("Memory allocation error.  Program will stop.");
+		exit (1);
+	}
+	wavefront_fill(&w, threads);
+	tile_scratch_init(&w, &t);
+
+	run.sink = sink;
+	run.count = 0;
+	while(p > 0)
+	{
+		//The tile holding the step from row p - 1 to row p at column q, which may be its right edge
+		row_block = (p - 1) / tile_rows;
+		column_block = q > 0 ? (q - 1) / tile_columns : 0;
+		row = row_block * tile_rows;
+		column = column_block * tile_columns;
+		refill_tile(&w, row_block, column_block, &t, down);
+
+		while(p > row && q >= column)
+		{
+			step = (int) (down[(size_t) (p - 1 - row) * stride + (q - column) / 64] >> ((q - column) % 64) & 1);
+			if(step == 0)
+			{
+				add_step(&run, EDIT_DELETE, M - p, N - q);
+				p--;
+			}
+			else if(q > 0 && a[p - 1] == b[q - 1])
+			{
+				add_step(&run, EDIT_COMMON, M - p, N - q);
+				p--;
+				q--;
+			}
+			else
+			{
+				add_step(&run, EDIT_INSERT, M - p, N - q);
+				q--;
+			}
+		}
+	}
+	//All of x is used up, what is left of y is inserted
+	for(; q > 0; q--)
+		add_step(&run, EDIT_INSERT, M, N - q);
+	if(run.count > 0)
+		sink->emit(sink->context, run.op, run.x_start, run.y_start, run.count);
+
+	free(w.top);
+	free(w.left);
+	tile_scratch_free(&t);
+	free(down);
+	free(a);
+	free(b);
+}
+
+/*
+ * Name:
+ *	void wavefront_diff(const int* x, int M, const int* y, int N, edit_sink* sink)
+ *
+ * Input:
+ *	The two sequences, their lengths and where to send the edit script.
+ *
+ * Output:
+ *	Emits the same edit script as dp_diff, using wavefront_threads threads.
+ *
+ * Side Effects:
+ *	N/A
+ *
+ * Notes:
+ *	Tiles start at 4096 by 4096.  They grow for very large inputs so the edges stay within a quarter of a gigabyte;
+ *	the tile refilled for the path takes a bit per cell, and so at most do each thread's match masks.
+ */
+void wavefront_diff(const int* x, int M, const int* y, int N, edit_sink* sink)
+{
+	int threads = wavefront_threads > 0 ? wavefront_threads : (int) sysconf(_SC_NPROCESSORS_ONLN);
+	int tile = 4096;
+
+	//Each edge is a bit per cell, there are about M / tile rows of N of them and N / tile columns of M
+	while((double) M * N * 2 / tile / 8 > (256 << 20) && tile < 32768)
+		tile = tile * 2;
+	wavefront_diff_tiled(x, M, y, N, max(threads, 1), tile, tile, sink);
+}
+
+//What the merged output needs to print a run, the two lines the engine was given
+typedef struct merge_context
+{
+	const char* x_line;
+	const char* y_line;
+} merge_context;
+
+/*
+ * Name:
+ *	static void print_merged(void* context, int op, int x_start, int y_start, int count)
+ *
+ * Input:
+ *	A merge_context and one run of an edit script.
+ *
+ * Output:
+ *	Prints the run the way --show-all-lines shows it.  Common characters are printed as they are,
+ *	(>c) is a character only in the first file and (<c) a character only in the second.
+ *
+ * Side Effects:
+ *	Writes to stdout.
+ *
+ */
+static void print_merged(void* context, int op, int x_start, int y_start, int count)
+{
+	merge_context* lines = context;
+	int i;
+
+	if(op == EDIT_COMMON)
+		fwrite(&lines->x_line[x_start], 1, count, stdout);
+	else if(op == EDIT_DELETE)
+	{
+		for(i = 0; i < count; i++)
+			printf("(>%c)", lines->x_line[x_start + i]);
+	}
+	else
+	{
+		for(i = 0; i < count; i++)
+			printf("(<%c)", lines->y_line[y_start + i]);
+	}
+}
+
+/*
+ * Name:
+ *	void run_diff(int algorithm, const int* x, int M, const int* y, int N, edit_sink* sink)
+ *
+ * Input:
+ *	The engine to use, the two sequences, their lengths and where to send the edit script.
+ *
+ * Output:
+ *	Emits a shortest edit script turning x into y.
+ *
+ * Side Effects:
+ *	N/A
+ *
+ */
+void run_diff(int algorithm, const int* x, int M, const int* y, int N, edit_sink* sink)
+{
+	if(algorithm == ALGORITHM_DP)
+		dp_diff(x, M, y, N, sink);
+	else if(algorithm == ALGORITHM_HIRSCHBERG)
+		hirschberg_diff(x, M, y, N, sink);
+	else if(algorithm == ALGORITHM_WAVEFRONT)
+		wavefront_diff(x, M, y, N, sink);
+	else
+		myers_diff(x, M, y, N, sink);
+}
+
+//One distinct line, the id is its index in the table's insertion order
+typedef struct line_entry
+{
+	uint64_t hash;
+	const char* text;
+	int length;
+	int id;
+} line_entry;
+
+//Open addressing hash table from line contents to ids, shared by both files so equal lines get equal ids
+typedef struct line_table
+{
+	line_entry* entries;
+	size_t mask;
+	int count;
+} line_table;
+
+//The lines of one file.  Line i is text[start[i]..start[i+1]) and keeps its newline, so a missing one at the end of the file is a difference as it is to diff.
+typedef struct file_lines
+{
+	const char* text;
+	int count;
+	int* start;
+	int* ids;
+} file_lines;
+
+/*
+ * Name:
+ *	static uint64_t hash_line(const char* text, int length)
+ *
+ * Input:
+ *	The line and its length
+ *
+ * Output:
+ *	Returns a 64 bit hash of the line.
+ *
+ * Side Effects:
+ *	N/A
+ *
+ * Notes:
+ *	Takes eight bytes per multiply rather than one, lines of source or data are mostly long enough for that to matter.
+ */
+static uint64_t hash_line(const char* text, int length)
+{
+	uint64_t h = 0x9E3779B97F4A7C15ULL ^ (uint64_t) length;
+	uint64_t word;
+
+	while(length >= 8)
+	{
+		memcpy(&word, text, 8);
+		h = (h ^ word) * 0xFF51AFD7ED558CCDULL;
+		h ^= h >> 32;
+		text += 8;
+		length -= 8;
+	}
+	word = 0;
+	memcpy(&word, text, length);
+	h = (h ^ word) * 0xC4CEB9FE1A85EC53ULL;
+	return h ^ (h >> 29);
+}
+
+/*
+ * Name:
+ *	void line_table_init(line_table* table, int lines)
+ *
+ * Input:
+ *	The table and how many lines will be interned into it at most
+ *
+ * Output:
+ *	N/A
+ *
+ * Side Effects:
+ *	Allocates the table with at least twice as many slots as lines, so probe sequences stay short.
+ *	line_table_free releases it.
+ *
+ */
+void line_table_init(line_table* table, int lines)
+{
+	size_t slots = 16;
+
+	while(slots < 2 * (size_t) lines)
+		slots = slots * 2;
+	table->entries = calloc(slots, sizeof(line_entry));
+	if(table->entries == NULL)
+	{
+		puts("Memory allocation error.  Program will stop.");
+		exit (1);
+	}
+	table->mask = slots - 1;
+	table->count = 0;
+}
+
+void line_table_free(line_table* table)
+{
+	free(table->entries);
+	table->entries = NULL;
+}
+
+/*
+ * Name:
+ *	int intern_line(line_table* table, const char* text, int length)
+ *
+ * Input:
+ *	The table and a line with its length
+ *
+ * Output:
+ *	Returns the id of the line, the same id every time the same contents are passed in.
+ *
+ * Side Effects:
+ *	The table keeps a pointer to the text, which must outlive it.
+ *
+ */
+int intern_line(line_table* table, const char* text, int length)
+{
+	uint64_t hash = hash_line(text, length);
+	size_t slot = (size_t) hash & table->mask;
+	line_entry* entry;
+
+	//Empty slots have a NULL text, the full hash is compared before the contents
+	for(;;)
+	{
+		entry = &table->entries[slot];
+		if(entry->text == NULL)
+			break;
+		if(entry->hash == hash && entry->length == length && memcmp(entry->text, text, length) == 0)
+			return entry->id;
+		slot = (slot + 1) & table->mask;
+	}
+	entry->hash = hash;
+	entry->text = text;
+	entry->length = length;
+	entry->id = table->count++;
+	return entry->id;
+}
+
+/*
+ * Name:
+ *	int count_lines(const char* text, int length)
+ *
+ * Input:
+ *	A buffer and its length
+ *
+ * Output:
+ *	Returns how many lines the buffer has, counting a last line with no newline.
+ *
+ * Side Effects:
+ *	N/A
+ *
+ */
+int count_lines(const char* text, int length)
+{
+	int lines = 0;
+	const char* end = text + length;
+	const char* p = text;
+
+	while((p = memchr(p, '\n', end - p)) != NULL)
+	{
+		lines++;
+		p++;
+	}
+	if(length > 0 && text[length - 1] != '\n')
+		lines++;
+	return lines;
+}
+
+/*
+ * Name:
+ *	void split_lines(const char* text, int length, line_table* table, file_lines* lines)
+ *
+ * Input:
+ *	A buffer and its length, the table to intern into and the file_lines to fill in.
+ *
+ * Output:
+ *	N/A
+ *
+ * Side Effects:
+ *	Allocates lines->start and lines->ids, free_lines releases them.
+ *
+ */
+void split_lines(const char* text, int length, line_table* table, file_lines* lines)
+{
+	int count = count_lines(text, length);
+	int i = 0;
+	int offset = 0;
+	const char* newline;
+
+	lines->text = text;
+	lines->count = count;
+	lines->start = malloc(sizeof(int) * (count + 1));
+	lines->ids = malloc(sizeof(int) * (count > 0 ? count : 1));
+	if(lines->start == NULL || lines->ids == NULL)
+	{
+		puts("Memory allocation error.  Program will stop.");
+		exit (1);
+	}
+
+	for(i = 0; i < count; i++)
+	{
+		lines->start[i] = offset;
+		newline = memchr(text + offset, '\n', length - offset);
+		offset = newline != NULL ? (int) (newline - text) + 1 : length;
+		lines->ids[i] = intern_line(table, text + lines->start[i], offset - lines->start[i]);
+	}
+	lines->start[count] = length;
+}
+
+void free_lines(file_lines* lines)
+{
+	free(lines->start);
+	free(lines->ids);
+}
+
+//A change being collected for print_hunk, the lines deleted from x and inserted from y since the last common line
+typedef struct hunk_context
+{
+	const file_lines* x;
+	const file_lines* y;
+	int x_start;
+	int x_count;
+	int y_start;
+	int y_count;
+} hunk_context;
+
+/*
+ * Name:
+ *	static void print_range(int start, int count)
+ *
+ * Input:
+ *	The first line of a range counting from zero and how many lines it has
+ *
+ * Output:
+ *	Prints the range as diff does, one based with a comma only if it has more than one line.
+ *	An empty range is printed as the line before it.
+ *
+ * Side Effects:
+ *	Writes to stdout.
+ *
+ */
+static void print_range(int start, int count)
+{
+	if(count == 0)
+		printf("%d", start);
+	else if(count == 1)
+		printf("%d", start + 1);
+	else
+		printf("%d,%d", start + 1, start + count);
+}
+
+/*
+ * Name:
+ *	static void print_lines(const char* prefix, const file_lines* lines, int start, int count)
+ *
+ * Input:
+ *	The prefix to put in front of each line, the file's lines and the range to print
+ *
+ * Output:
+ *	Prints the lines, and diff's marker after a last line that has no newline.
+ *
+ * Side Effects:
+ *	Writes to stdout.
+ *
+ */
+static void print_lines(const char* prefix, const file_lines* lines, int start, int count)
+{
+	int i;
+	int length;
+
+	for(i = start; i < start + count; i++)
+	{
+		length = lines->start[i + 1] - lines->start[i];
+		fputs(prefix, stdout);
+		fwrite(lines->text + lines->start[i], 1, length, stdout);
+		if(lines->text[lines->start[i] + length - 1] != '\n')
+			fputs("\n\\ No newline at end of file\n", stdout);
+	}
+}
+
+/*
+ * Name:
+ *	static void print_hunk(hunk_context* hunk)
+ *
+ * Input:
+ *	The change collected so far
+ *
+ * Output:
+ *	Prints the change in diff's normal format, as a (a)dd, (d)elete or (c)hange command followed by the lines.
+ *
+ * Side Effects:
+ *	Writes to stdout and empties the hunk.
+ *
+ */
+static void print_hunk(hunk_context* hunk)
+{
+	if(hunk->x_count == 0 && hunk->y_count == 0)
+		return;
+
+	print_range(hunk->x_start, hunk->x_count);
+	if(hunk->x_count == 0)
+		putchar('a');
+	else if(hunk->y_count == 0)
+		putchar('d');
+	else
+		putchar('c');
+	print_range(hunk->y_start, hunk->y_count);
+	putchar('\n');
+
+	print_lines("< ", hunk->x, hunk->x_start, hunk->x_count);
+	if(hunk->x_count > 0 && hunk->y_count > 0)
+		puts("---");
+	print_lines("> ", hunk->y, hunk->y_start, hunk->y_count);
+
+	hunk->x_count = 0;
+	hunk->y_count = 0;
+}
+
+/*
+ * Name:
+ *	static void collect_hunk(void* context, int op, int x_start, int y_start, int count)
+ *
+ * Input:
+ *	A hunk_context and one run of an edit script over line ids.
+ *
+ * Output:
+ *	Deleted and inserted lines are added to the current change, which is printed when a common line ends it.
+ *
+ * Side Effects:
+ *	Writes to stdout.
+ *
+ */
+static void collect_hunk(void* context, int op, int x_start, int y_start, int count)
+{
+	hunk_context* hunk = context;
+
+	if(op == EDIT_COMMON)
+	{
+		print_hunk(hunk);
+		return;
+	}
+	if(hunk->x_count == 0 && hunk->y_count == 0)
+	{
+		hunk->x_start = x_start;
+		hunk->y_start = y_start;
+	}
+	if(op == EDIT_DELETE)
+		hunk->x_count += count;
+	else
+		hunk->y_count += count;
+}
+
+/*
+ * Name:
+ *	void line_diff(int algorithm, const char* sequence_x, int sequence_x_length, const char* sequence_y, int sequence_y_length)
+ *
+ * Input:
+ *	The engine to use and the contents of the two files
+ *
+ * Output:
+ *	Prints the differences between the files line by line, as diff does.
+ *
+ * Side Effects:
+ *	Writes to stdout.
+ *
+ */
+void line_diff(int algorithm, const char* sequence_x, int sequence_x_length, const char* sequence_y, int sequence_y_length)
+{
+	line_table table;
+	file_lines x, y;
+	hunk_context hunk;
+	edit_sink sink;
+
+	line_table_init(&table, count_lines(sequence_x, sequence_x_length) + count_lines(sequence_y, sequence_y_length));
+	split_lines(sequence_x, sequence_x_length, &table, &x);
+	split_lines(sequence_y, sequence_y_length, &table, &y);
+
+	hunk.x = &x;
+	hunk.y = &y;
+	hunk.x_count = 0;
+	hunk.y_count = 0;
+	sink.emit = collect_hunk;
+	sink.context = &hunk;
+	run_diff(algorithm, x.ids, x.count, y.ids, y.count, &sink);
+	//A change that runs to the end of the files has no common line after it
+	print_hunk(&hunk);
+
+	free_lines(&x);
+	free_lines(&y);
+	line_table_free(&table);
+}
+
+/*
+ * Name:
+ *	void fixed_width_diff(int algorithm, int line_size, int show_all_lines, int similarity, char* x_name, const char* sequence_x, int sequence_x_length, char* y_name, const char* sequence_y, int sequence_y_length)
+ *
+ * Input:
+ *	The engine to use, the line size, whether to show the merged contents, whether to score lines and the names and contents of the two files
+ *
+ * Output:
+ *	Compares line i of one file with line i of the other, every line being line_size characters, and prints the lines that differ.
+ *	With similarity each of them is followed by 2 * LCS / (M + N), the share of both lines that is in common.
+ *	With show_all_lines the merged contents of every line are printed instead.
+ *
+ * Side Effects:
+ *	Writes to stdout.
+ *
+ */
+void fixed_width_diff(int algorithm, int line_size, int show_all_lines, int similarity, char* x_name, const char* sequence_x, int sequence_x_length, char* y_name, const char* sequence_y, int sequence_y_length)
+{
+	//The same contents as symbols for the diff engines
+	int* symbols_x = get_symbols(sequence_x, sequence_x_length);
+	int* symbols_y = get_symbols(sequence_y, sequence_y_length);
+
+	//Line lengths, line_size or less
+	int x_line_length = 0;
+	int y_line_length = 0;
+
+	//Index counters, used to keep track of how much we have read relative to the entire file size
+	int x_idx = 0;
+	int y_idx = 0;
+
+	//Boolean switches to indicate when we are done processing each of our files.
+	int x_done = 0;
+	int y_done = 0;
+
+	merge_context lines;
+	edit_sink merged;
+
+	merged.emit = print_merged;
+	merged.context = &lines;
+
+	//Line i of one file is compared with line i of the other until both files run out
+	while( x_done < 1 || y_done < 1)
+	{
+			//If we can read a full line
+			if(x_idx + line_size < sequence_x_length)
+			{
+				x_line_length = line_size;
+			}
+			else
+			{
+				//Since we cant read a full line, read as much as is left
+				x_line_length = sequence_x_length - x_idx;
+				x_done = 1;
+			}
+			x_idx = x_idx + x_line_length;
+
+			//This code is the same as the above code but for our second input file
+			if(y_idx + line_size < sequence_y_length)
+			{
+				y_line_length = line_size;
+			}
+			else
+			{
+				y_line_length = sequence_y_length - y_idx;
+				y_done = 1;
+			}
+			y_idx = y_idx + y_line_length;
+
+			lines.x_line = &sequence_x[x_idx - x_line_length];
+			lines.y_line = &sequence_y[y_idx - y_line_length];
+
+			/*
+			 * In most cases we don't care about seeing the merged contents.
+			 * Lines that are not the same are displayed side by side, and telling that only needs a comparison.
+			 *
+			 * Now if the user has included the --show-all-lines option, then we should show the merged result.
+			 * The diff engine works out which characters differed and the sink prints them as it goes.
+			 */
+			if(show_all_lines < 1)
+			{
+				if(x_line_length == y_line_length && memcmp(lines.x_line, lines.y_line, x_line_length) == 0)
+				{
+					continue;
+				}
+
+				//Display the lines aligned as diff does
+				//This will allow the user to easiily see how the files differed.
+				printf("Difference located at starting at %s:%d-%d and %s:%d-%d:\r\n", x_name,  x_idx-x_line_length, x_idx, y_name, y_idx-y_line_length, y_idx);
+				printf("< %.*s | \r\n> %.*s", x_line_length, lines.x_line, y_line_length, lines.y_line);
+				if(similarity > 0)
+				{
+					printf("\r\nSimilarity: %.2f%%", 200.0 * bit_lcs_length(&symbols_x[x_idx - x_line_length], x_line_length, &symbols_y[y_idx - y_line_length], y_line_length) / (x_line_length + y_line_length));
+				}
+				printf("\r\n\r\n");
+			}
+			else
+			{
+				run_diff(algorithm, &symbols_x[x_idx - x_line_length], x_line_length, &symbols_y[y_idx - y_line_length], y_line_length, &merged);
+			}
+	}
+	free(symbols_x);
+	free(symbols_y);
+	printf("\r\n");
+}
+
+//Benchmark.c includes this file for the engines and has a main of its own
+#ifndef LCS_NO_MAIN
+int main(int argc, char* argv[])
+{
+	//Optional argument switches
+	int show_all_lines = 0;
+	int similarity = 0;
+	int algorithm = ALGORITHM_MYERS;
+	int fixed_width = 0;
+	int line_size = LINE_SIZE;
+
+	//File contents pointers
+	char* sequence_x = NULL;
+	char* sequence_y = NULL;
+
+	//Total file lengths
+	int sequence_x_length = 0;
+	int sequence_y_length = 0;
+
+	int i = 0;
+
+	if(argc >= 3)
+	{
+			//Read our two files to get their contents
+			sequence_x = get_file_contents(argv[1],  &sequence_x_length);
+			sequence_y = get_file_contents(argv[2], &sequence_y_length);
+	}
+	else
+	{
+			//We need a minimum of two command line arguments
+			puts("Invalid arguments. Arguments at minimum must include two files.  Please try again.");
+			exit(0);
+	}
+
+	//Check for our optional flags, if present, set our switches.
+	for(i = 3; i < argc; i++)
+	{
+		if(strcmp(argv[i], "--show-all-lines") == 0)
+		{
+			//The merged contents are shown character by character, so they need fixed width lines
+			show_all_lines = 1;
+			fixed_width = 1;
+		}
+		else if(strcmp(argv[i], "--similarity") == 0)
+		{
+			similarity = 1;
+			fixed_width = 1;
+		}
+		else if(strcmp(argv[i], "--algorithm=myers") == 0)
+		{
+			algorithm = ALGORITHM_MYERS;
+		}
+		else if(strcmp(argv[i], "--algorithm=dp") == 0)
+		{
+			algorithm = ALGORITHM_DP;
+		}
+		else if(strcmp(argv[i], "--algorithm=hirschberg") == 0)
+		{
+			algorithm = ALGORITHM_HIRSCHBERG;
+		}
+		else if(strcmp(argv[i], "--algorithm=wavefront") == 0)
+		{
+			algorithm = ALGORITHM_WAVEFRONT;
+		}
+		else if(strncmp(argv[i], "--threads=", 10) == 0 && atoi(argv[i] + 10) > 0)
+		{
+			wavefront_threads = atoi(argv[i] + 10);
+		}
+		else if(strncmp(argv[i], "--width=", 8) == 0 && atoi(argv[i] + 8) >= 0)
+		{
+			line_size = atoi(argv[i] + 8);
+			fixed_width = 1;
+		}
+		else
+		{
+			printf("Invalid argument %s.  Please try again.\n", argv[i]);
+			exit(0);
+		}
+	}
+	//A width of zero is the whole file
+	if(line_size == 0)
+	{
+		line_size = max(max(sequence_x_length, sequence_y_length), 1);
+	}
+
+	if(fixed_width)
+		fixed_width_diff(algorithm, line_size, show_all_lines, similarity, argv[1], sequence_x, sequence_x_length, argv[2], sequence_y, sequence_y_length);
+	else
+		line_diff(algorithm, sequence_x, sequence_x_length, sequence_y, sequence_y_length);
+
+	//Clean up memory and end
+	free(sequence_x);
+	free(sequence_y);
 	return 0;
 
 }
+#endif
@@ -0,0 +1,718 @@
+/*
+ * Benchmark.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Timing driver for the red-black trees in this directory.
+ *
+ *  Build with
+ *
+ *  $ g++ -std=c++11 -O2 -pthread Benchmark.cpp RB_Node.cpp -o rbtree_bench
+ *
+ *  and run as
+ *
+ *  rbtree_bench <mode> [args]
+ *
+ *  modes:
+ *	layout [keys]			build, lookup and memory of every node layout, std::set as the baseline
+ *	interval [intervals] [queries]	RB_IntervalTree overlap queries, one at a time and batched, against a linear scan
+ *	setops [keys]			join based union, intersection, difference and sorted build at 1 thread up to all cores
+ *	persistent [keys] [seconds]	RB_PersistentTree lookups and writes running together, against a std::set behind a mutex
+ *	frozen [max keys]		RB_Freeze lookups against the live tree and a sorted array, from L1 size up to 10x the last level cache,
+ *					after checking that a build whose key source throws cleans up
+ *	dump [keys]			in-order walk and RB_Dump to /dev/null against a stream flushed after every key
+ *	stats [keys]			random inserts and deletes, then the RB_StatsSnapshot counters (build with -DRB_STATS)
+ */
+
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <set>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <malloc.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <stdexcept>
+#include "RB_Tree.h"
+#include "RB_Set.h"
+#include "RB_IndexTree.h"
+#include "RB_IntervalTree.h"
+#include "RB_Join.h"
+#include "RB_PersistentTree.h"
+
+using namespace std;
+
+class FastRandom{
+
+	private:
+		uint64_t state;
+
+	public:
+		FastRandom(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ull + 1) {}
+		uint64_t next()
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			return state;
+		}
+};
+
+static double secondsSince(chrono::steady_clock::time_point start)
+{
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static size_t heapInUse()
+{
+	struct mallinfo2 info = mallinfo2();
+	return info.uordblks + info.hblkhd;
+}
+
+//Every structure below is driven through insert and search
+struct StdSet
+{
+	set<int> keys;
+	void insert(int key) { keys.insert(key); }
+	bool search(int key) { return keys.find(key) != keys.end(); }
+};
+
+//Intrusive tree with one new per node, the way callers used RB_Tree before
+struct NewedNodes
+{
+	struct Item : public RB_Node
+	{
+		int key;
+	};
+	RB_Tree<Item> tree;
+
+	//Same rotate-left-children-up teardown as RB_Set
+	~NewedNodes()
+	{
+		RB_Node* x = tree.RB_GetRoot();
+		while(x != NULL)
+		{
+			if(x->left != NULL)
+			{
+				RB_Node* l = x->left;
+				x->left = l->right;
+				l->right = x;
+				x = l;
+			}
+			else
+			{
+				RB_Node* next = x->right;
+				delete static_cast<Item*>(x);
+				x = next;
+			}
+		}
+	}
+	void insert(int key)
+	{
+		Item* item = new Item();
+		item->key = key;
+		if(tree.RB_InsertUnique(item) != item)
+			delete item;
+	}
+	bool search(int key) { return tree.RB_Find(key) != NULL; }
+};
+
+struct PooledSet
+{
+	RB_Set<int> keys;
+	void insert(int key) { keys.RB_Insert(key); }
+	bool search(int key) { return keys.RB_Contains(key); }
+};
+
+struct IndexTree
+{
+	RB_IndexTree<int> keys;
+	void insert(int key) { keys.RB_Insert(key); }
+	bool search(int key) { return keys.RB_Contains(key); }
+};
+
+//Inserts keys in random order, looks them all up in another random order, then tears down
+template <class Tree>
+static void runLayout(const char* name, size_t nodeBytes, const vector<int>& keys, const vector<int>& probes)
+{
+	size_t before = heapInUse();
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	Tree* tree = new Tree();
+	for(size_t i = 0; i < keys.size(); i++)
+		tree->insert(keys[i]);
+	double build = secondsSince(start);
+	size_t footprint = heapInUse() - before;
+
+	start = chrono::steady_clock::now();
+	long found = 0;
+	for(size_t i = 0; i < probes.size(); i++)
+		found += tree->search(probes[i]) ? 1 : 0;
+	double lookup = secondsSince(start);
+
+	start = chrono::steady_clock::now();
+	delete tree;
+	double teardown = secondsSince(start);
+
+	cout << name << "," << nodeBytes << "," << keys.size() << "," << build << "," << lookup * 1e9 / probes.size() << ","
+		<< teardown << "," << (double)footprint / keys.size() << "," << found << endl;
+}
+
+static void benchLayout(int n)
+{
+	vector<int> keys(n);
+	FastRandom rng(7);
+	for(int i = 0; i < n; i++)
+		keys[i] = i * 2;
+	for(int i = n - 1; i > 0; i--)
+		swap(keys[i], keys[rng.next() % (i + 1)]);
+	vector<int> probes(keys);
+	for(int i = n - 1; i > 0; i--)
+		swap(probes[i], probes[rng.next() % (i + 1)]);
+
+	cout << "structure,node_bytes,keys,build_s,lookup_ns,teardown_s,bytes_per_key,found" << endl;
+	//libstdc++ nodes are the old RB_Node layout: enum color, three pointers and the key
+	runLayout<StdSet>("std::set", 40, keys, probes);
+	runLayout<NewedNodes>("RB_Tree new per node", sizeof(NewedNodes::Item), keys, probes);
+	runLayout<PooledSet>("RB_Set pool", sizeof(NewedNodes::Item), keys, probes);
+	runLayout<IndexTree>("RB_IndexTree", 16, keys, probes);
+}
+
+struct Window : public RB_IntervalNode<int>
+{
+	Window(int l, int h) : RB_IntervalNode<int>(l, h) {}
+};
+
+/*
+ * Random windows up to 1000 wide over a range 1000 times the number of windows,
+ * queried with random windows up to 100 wide, so each query matches a handful.
+ */
+static void benchInterval(int n, int queries)
+{
+	FastRandom rng(13);
+	int range = n * 1000;
+	vector<Window> windows;
+	windows.reserve(n);
+	for(int i = 0; i < n; i++)
+	{
+		int low = (int)(rng.next() % range);
+		windows.push_back(Window(low, low + (int)(rng.next() % 1000)));
+	}
+	vector<int> lo(queries);
+	vector<int> hi(queries);
+	for(int i = 0; i < queries; i++)
+	{
+		lo[i] = (int)(rng.next() % range);
+		hi[i] = lo[i] + (int)(rng.next() % 100);
+	}
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	RB_IntervalTree<Window> tree;
+	for(int i = 0; i < n; i++)
+		tree.RB_Insert(&windows[i]);
+	double build = secondsSince(start);
+
+	cout << "method,intervals,queries,build_s,us_per_query,matches" << endl;
+
+	//The scan is far slower, so it gets a slice of the queries and is scaled up
+	int scanned = min(queries, max(1, (int)(2e8 / n)));
+	start = chrono::steady_clock::now();
+	long matches = 0;
+	for(int q = 0; q < scanned; q++)
+	{
+		for(int i = 0; i < n; i++)
+			matches += (windows[i].low <= hi[q] && lo[q] <= windows[i].high) ? 1 : 0;
+	}
+	cout << "scan," << n << "," << scanned << ",0," << secondsSince(start) * 1e6 / scanned << "," << matches << endl;
+
+	start = chrono::steady_clock::now();
+	matches = 0;
+	for(int q = 0; q < queries; q++)
+		tree.RB_Overlap(lo[q], hi[q], [&](Window*) { matches++; });
+	cout << "tree," << n << "," << queries << "," << build << "," << secondsSince(start) * 1e6 / queries << "," << matches << endl;
+
+	//Batches work best on queries in order, as a sorted stream of windows would be
+	vector<int> order(queries);
+	for(int q = 0; q < queries; q++)
+		order[q] = q;
+	sort(order.begin(), order.end(), [&](int a, int b) { return lo[a] < lo[b]; });
+	vector<int> sortedLo(queries);
+	vector<int> sortedHi(queries);
+	for(int q = 0; q < queries; q++)
+	{
+		sortedLo[q] = lo[order[q]];
+		sortedHi[q] = hi[order[q]];
+	}
+	for(int batch = 16; batch <= 1024; batch *= 4)
+	{
+		start = chrono::steady_clock::now();
+		matches = 0;
+		for(int q = 0; q < queries; q += batch)
+			tree.RB_OverlapBatch(&sortedLo[q], &sortedHi[q], min(batch, queries - q), [&](size_t, Window*) { matches++; });
+		cout << "batch " << batch << "," << n << "," << queries << "," << build << "," << secondsSince(start) * 1e6 / queries << "," << matches << endl;
+	}
+}
+
+typedef NewedNodes::Item Item;
+typedef RB_Tree<Item> ItemTree;
+typedef RB_JoinOps<Item, RB_KeyTraits<Item> > ItemJoin;
+
+//n nodes with every other key from start, so two sets from start 0 and 1 interleave
+static vector<Item*> makeItems(int n, int start)
+{
+	vector<Item*> items(n);
+	for(int i = 0; i < n; i++)
+	{
+		items[i] = new Item();
+		items[i]->key = start + i * 2;
+	}
+	return items;
+}
+
+static void freeItems(vector<Item*>& items)
+{
+	for(size_t i = 0; i < items.size(); i++)
+		delete items[i];
+}
+
+/*
+ * Two sets of n keys, each half shared with the other, merged by the join
+ * based operations at every thread count from 1 to the number of cores, and
+ * once by reinserting every node of the second set as a baseline.
+ */
+static void benchSetOps(int n)
+{
+	//Keys 0, 2, 4 ... and n, n + 2, n + 4 ... share the half between n and 2n
+	vector<Item*> a = makeItems(n, 0);
+	vector<Item*> b = makeItems(n, n - n % 2);
+	ItemTree left;
+	ItemTree right;
+	//Dropped nodes go back to their vector, so the dispose callback has nothing to do
+	auto dispose = [](Item*) {};
+
+	cout << "operation,keys,threads,seconds,result_size" << endl;
+
+	ItemJoin::Threads() = 1;
+	RB_BuildSorted(left, &a[0], a.size());
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for(int i = 0; i < n; i++)
+		left.RB_InsertUnique(b[i]);
+	cout << "reinsert union," << n << ",1," << secondsSince(start) << "," << left.RB_Size() << endl;
+	left.RB_Clear();
+
+	unsigned cores = thread::hardware_concurrency();
+	if(cores < 1)
+		cores = 1;
+	vector<unsigned> sweep;
+	for(unsigned threads = 1; threads < cores; threads *= 2)
+		sweep.push_back(threads);
+	sweep.push_back(cores);
+	for(size_t t = 0; t < sweep.size(); t++)
+	{
+		unsigned threads = sweep[t];
+		ItemJoin::Threads() = threads;
+
+		start = chrono::steady_clock::now();
+		RB_BuildSorted(left, &a[0], a.size());
+		cout << "build," << n << "," << threads << "," << secondsSince(start) << "," << left.RB_Size() << endl;
+
+		RB_BuildSorted(right, &b[0], b.size());
+		start = chrono::steady_clock::now();
+		RB_Union(left, right, dispose);
+		cout << "union," << n << "," << threads << "," << secondsSince(start) << "," << left.RB_Size() << endl;
+		left.RB_Clear();
+
+		RB_BuildSorted(left, &a[0], a.size());
+		RB_BuildSorted(right, &b[0], b.size());
+		start = chrono::steady_clock::now();
+		RB_Intersection(left, right, dispose);
+		cout << "intersection," << n << "," << threads << "," << secondsSince(start) << "," << left.RB_Size() << endl;
+		left.RB_Clear();
+
+		RB_BuildSorted(left, &a[0], a.size());
+		RB_BuildSorted(right, &b[0], b.size());
+		start = chrono::steady_clock::now();
+		RB_Difference(left, right, dispose);
+		cout << "difference," << n << "," << threads << "," << secondsSince(start) << "," << left.RB_Size() << endl;
+		left.RB_Clear();
+	}
+	freeItems(a);
+	freeItems(b);
+}
+
+/*
+ * One writer inserting and deleting random keys while one reader looks keys
+ * up, each for the given time.  The persistent tree's reader never waits on
+ * the writer, a std::set has to share one lock between them.
+ */
+static void benchPersistent(int n, int seconds)
+{
+	RB_PersistentTree<int> tree;
+	set<int> locked;
+	mutex lock;
+	for(int i = 0; i < n; i += 2)
+	{
+		tree.RB_Insert(i);
+		locked.insert(i);
+	}
+
+	cout << "structure,keys,writer,writes_per_sec,lookups_per_sec" << endl;
+	for(int structure = 0; structure <= 1; structure++)
+	{
+		for(int writing = 0; writing <= 1; writing++)
+		{
+			atomic<bool> stop(false);
+			long writes = 0;
+			thread writer;
+			if(writing)
+			{
+				writer = thread([&]() {
+					FastRandom rng(17);
+					while(!stop.load())
+					{
+						int key = (int)(rng.next() % n);
+						bool insert = (rng.next() & 1) != 0;
+						if(structure == 0)
+						{
+							if(insert)
+								tree.RB_Insert(key);
+							else
+								tree.RB_Delete(key);
+						}
+						else
+						{
+							lock_guard<mutex> held(lock);
+							if(insert)
+								locked.insert(key);
+							else
+								locked.erase(key);
+						}
+						writes++;
+					}
+				});
+			}
+
+			FastRandom rng(19);
+			long lookups = 0;
+			long found = 0;
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			while(secondsSince(start) < seconds)
+			{
+				for(int i = 0; i < 1024; i++, lookups++)
+				{
+					int key = (int)(rng.next() % n);
+					if(structure == 0)
+						found += tree.RB_Contains(key) ? 1 : 0;
+					else
+					{
+						lock_guard<mutex> held(lock);
+						found += locked.count(key);
+					}
+				}
+			}
+			double elapsed = secondsSince(start);
+			stop.store(true);
+			if(writing)
+				writer.join();
+			cout << (structure == 0 ? "RB_PersistentTree" : "std::set + mutex") << "," << n << "," << (writing ? "yes" : "no") << "," << (long)(writes / elapsed) << "," << (long)(lookups / elapsed) << endl;
+		}
+	}
+}
+
+static size_t cacheSize(int name, size_t fallback)
+{
+	long size = sysconf(name);
+	return size > 0 ? (size_t) size : fallback;
+}
+
+//String key that counts its live copies, so a failed build can be seen to destroy exactly what it built
+struct CountedKey
+{
+	static long live;
+	string text;
+
+	CountedKey(const string& t) : text(t) { live++; }
+	CountedKey(const CountedKey& other) : text(other.text) { live++; }
+	~CountedKey() { live--; }
+	bool operator<(const CountedKey& other) const { return text < other.text; }
+};
+
+long CountedKey::live = 0;
+
+/*
+ * Builds a frozen tree of 100 string keys from a generator that throws at key
+ * 50.  The build must destroy the 50 keys it made, leave the tree empty and
+ * still build normally afterwards.
+ */
+static int checkFrozenBuild()
+{
+	const int n = 100;
+	char text[32];
+	RB_FrozenTree<CountedKey> frozen;
+	int made = 0;
+	bool threw = false;
+	try
+	{
+		frozen.RB_Build(n, [&]() {
+			if(made == n / 2)
+				throw runtime_error("generator failed");
+			snprintf(text, sizeof(text), "key %03d with a heap sized tail", made++);
+			return CountedKey(text);
+		});
+	}
+	catch(runtime_error&)
+	{
+		threw = true;
+	}
+	if(!threw || CountedKey::live != 0 || !frozen.RB_Empty())
+	{
+		cout << "frozen build that threw left " << CountedKey::live << " keys alive and " << frozen.RB_Size() << " in the tree" << endl;
+		return 1;
+	}
+
+	made = 0;
+	frozen.RB_Build(n, [&]() {
+		snprintf(text, sizeof(text), "key %03d with a heap sized tail", made++);
+		return CountedKey(text);
+	});
+	snprintf(text, sizeof(text), "key %03d with a heap sized tail", n - 1);
+	if(frozen.RB_Size() != (size_t) n || !frozen.RB_Contains(CountedKey(text)))
+	{
+		cout << "frozen build after a failed one is wrong" << endl;
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Lookups of random keys, half of them present, in the live tree, a sorted
+ * array with std::lower_bound and the frozen tree one at a time and batched.
+ * Sizes grow 4x at a time from an L1 sized key array to maxKeys.
+ */
+static int benchFrozen(size_t maxKeys)
+{
+	if(checkFrozenBuild() != 0)
+		return 1;
+
+
+	size_t l1 = cacheSize(_SC_LEVEL1_DCACHE_SIZE, 32 << 10);
+	size_t l2 = cacheSize(_SC_LEVEL2_CACHE_SIZE, 1 << 20);
+	size_t llc = cacheSize(_SC_LEVEL3_CACHE_SIZE, 32 << 20);
+	if(maxKeys == 0)
+		maxKeys = llc * 10 / sizeof(int);
+	const size_t probeCount = 1 << 20;
+
+	cout << "structure,keys,key_bytes,fits_in,ns_per_lookup,found" << endl;
+	for(size_t n = l1 / sizeof(int); n <= maxKeys; n *= 4)
+	{
+		//Even keys only, so odd probes miss
+		vector<int> sorted(n);
+		for(size_t i = 0; i < n; i++)
+			sorted[i] = (int)(i * 2);
+		vector<int> shuffled(sorted);
+		FastRandom rng(23);
+		for(size_t i = n - 1; i > 0; i--)
+			swap(shuffled[i], shuffled[rng.next() % (i + 1)]);
+		vector<int> probes(probeCount);
+		for(size_t i = 0; i < probeCount; i++)
+			probes[i] = (int)(rng.next() % (n * 2));
+
+		size_t bytes = n * sizeof(int);
+		const char* fits = bytes <= l1 ? "L1" : bytes <= l2 ? "L2" : bytes <= llc ? "LLC" : "memory";
+
+		long found = 0;
+		chrono::steady_clock::time_point start;
+		{
+			vector<Item> items(n);
+			ItemTree tree;
+			for(size_t i = 0; i < n; i++)
+			{
+				items[i].key = shuffled[i];
+				tree.RB_Insert(&items[i]);
+			}
+			start = chrono::steady_clock::now();
+			for(size_t i = 0; i < probeCount; i++)
+				found += tree.RB_Find(probes[i]) != NULL ? 1 : 0;
+			cout << "RB_Tree," << n << "," << bytes << "," << fits << "," << secondsSince(start) * 1e9 / probeCount << "," << found << endl;
+
+			ItemTree::Frozen frozen = tree.RB_Freeze();
+			tree.RB_Clear();
+			items.clear();
+			items.shrink_to_fit();
+
+			found = 0;
+			start = chrono::steady_clock::now();
+			for(size_t i = 0; i < probeCount; i++)
+				found += frozen.RB_Contains(probes[i]) ? 1 : 0;
+			cout << "RB_Freeze," << n << "," << bytes << "," << fits << "," << secondsSince(start) * 1e9 / probeCount << "," << found << endl;
+
+			vector<const int*> results(probeCount);
+			found = 0;
+			start = chrono::steady_clock::now();
+			frozen.RB_LowerBoundBatch(&probes[0], probeCount, &results[0]);
+			for(size_t i = 0; i < probeCount; i++)
+				found += results[i] != NULL && *results[i] == probes[i] ? 1 : 0;
+			cout << "RB_Freeze batch," << n << "," << bytes << "," << fits << "," << secondsSince(start) * 1e9 / probeCount << "," << found << endl;
+		}
+
+		found = 0;
+		start = chrono::steady_clock::now();
+		for(size_t i = 0; i < probeCount; i++)
+			found += binary_search(sorted.begin(), sorted.end(), probes[i]) ? 1 : 0;
+		cout << "sorted array," << n << "," << bytes << "," << fits << "," << secondsSince(start) * 1e9 / probeCount << "," << found << endl;
+	}
+	return 0;
+}
+
+/*
+ * Walks and dumps a tree of n random keys.  The flushed stream is what
+ * ViewTree_PostOrder used to do, it gets a slice of the keys and is scaled up.
+ */
+static int benchDump(int n)
+{
+	vector<Item> items(n);
+	ItemTree tree;
+	FastRandom rng(29);
+	for(int i = 0; i < n; i++)
+	{
+		items[i].key = (int)(rng.next() >> 33);
+		tree.RB_Insert(&items[i]);
+	}
+	int null = open("/dev/null", O_WRONLY);
+	if(null < 0)
+	{
+		cout << "cannot open /dev/null" << endl;
+		return 1;
+	}
+
+	cout << "method,keys,seconds,ns_per_key" << endl;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	//Volatile so the walk is not optimized away
+	volatile long sum = 0;
+	for(ItemTree::iterator it = tree.begin(); it != tree.end(); ++it)
+		sum += it->key;
+	double elapsed = secondsSince(start);
+	cout << "iterate," << n << "," << elapsed << "," << elapsed * 1e9 / n << endl;
+
+	start = chrono::steady_clock::now();
+	bool written = tree.RB_Dump(null);
+	elapsed = secondsSince(start);
+	cout << "RB_Dump," << n << "," << elapsed << "," << elapsed * 1e9 / n << endl;
+
+	start = chrono::steady_clock::now();
+	bool rawWritten = tree.RB_DumpRaw(null);
+	elapsed = secondsSince(start);
+	cout << "RB_DumpRaw," << n << "," << elapsed << "," << elapsed * 1e9 / n << endl;
+	close(null);
+
+	int flushed = min(n, 1000000);
+	ofstream out("/dev/null");
+	start = chrono::steady_clock::now();
+	ItemTree::iterator it = tree.begin();
+	for(int i = 0; i < flushed; i++, ++it)
+		out << it->key << endl;
+	elapsed = secondsSince(start) * n / flushed;
+	cout << "endl per key," << n << "," << elapsed << "," << elapsed * 1e9 / n << endl;
+
+	if(!written || !rawWritten)
+	{
+		cout << "dump failed" << endl;
+		return 1;
+	}
+	return 0;
+}
+
+//Random inserts, then deletes of every other node, with the hot path counters
+static void benchStats(int n)
+{
+	vector<Item> items(n);
+	ItemTree tree;
+	FastRandom rng(37);
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for(int i = 0; i < n; i++)
+	{
+		items[i].key = (int)(rng.next() >> 33);
+		tree.RB_Insert(&items[i]);
+	}
+	for(int i = 0; i < n; i += 2)
+		tree.RB_Delete(&items[i]);
+	double elapsed = secondsSince(start);
+
+	RB_Stats stats = RB_StatsSnapshot();
+	cout << "keys " << tree.RB_Size() << ", " << elapsed * 1e9 / (n + n / 2) << " ns per operation" << endl;
+	if(!stats.enabled)
+	{
+		cout << "counters are compiled out, rebuild with -DRB_STATS" << endl;
+		return;
+	}
+	cout << "inserts " << stats.inserts << ", fixup loops per insert " << (double) stats.insertFixupLoops / stats.inserts
+		<< ", rotations per insert " << stats.RotationsPerInsert() << endl;
+	cout << "deletes " << stats.deletes << ", fixup loops per delete " << (double) stats.deleteFixupLoops / stats.deletes
+		<< ", rotations per delete " << stats.RotationsPerDelete() << endl;
+	cout << "mean insert depth " << stats.MeanInsertDepth() << endl;
+	cout << "depth,inserts" << endl;
+	for(int d = 0; d < RB_STATS_DEPTHS; d++)
+	{
+		if(stats.insertDepth[d] != 0)
+			cout << d << "," << stats.insertDepth[d] << endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc < 2)
+	{
+		cout << "Usage: " << argv[0] << " layout|interval|setops|persistent|frozen|dump|stats [args]" << endl;
+		return 1;
+	}
+
+	if(strcmp(argv[1], "layout") == 0)
+	{
+		benchLayout(argc > 2 ? atoi(argv[2]) : 10000000);
+		return 0;
+	}
+
+	if(strcmp(argv[1], "interval") == 0)
+	{
+		benchInterval(argc > 2 ? atoi(argv[2]) : 1000000, argc > 3 ? atoi(argv[3]) : 1000000);
+		return 0;
+	}
+
+	if(strcmp(argv[1], "setops") == 0)
+	{
+		benchSetOps(argc > 2 ? atoi(argv[2]) : 10000000);
+		return 0;
+	}
+
+	if(strcmp(argv[1], "persistent") == 0)
+	{
+		benchPersistent(argc > 2 ? atoi(argv[2]) : 1000000, argc > 3 ? atoi(argv[3]) : 3);
+		return 0;
+	}
+
+	if(strcmp(argv[1], "frozen") == 0)
+	{
+		//The default goes to 10x the last level cache, which needs tens of bytes of tree per key
+		return benchFrozen(argc > 2 ? strtoull(argv[2], NULL, 10) : 0);
+	}
+
+	if(strcmp(argv[1], "dump") == 0)
+		return benchDump(argc > 2 ? atoi(argv[2]) : 10000000);
+
+	if(strcmp(argv[1], "stats") == 0)
+	{
+		benchStats(argc > 2 ? atoi(argv[2]) : 1000000);
+		return 0;
+	}
+
+	cout << "Unknown mode " << argv[1] << endl;
+	return 1;
+}
@@ -0,0 +1,125 @@
+/*
+ * RB_Dump.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Buffered output to a file descriptor for dumping whole trees.
+ *
+ *  Keys are formatted straight into a large buffer that goes out with one
+ *  write() each time it fills, so a dump costs one system call per megabyte
+ *  instead of a flush per key.  RB_FormatKey has overloads for integers,
+ *  floating point and strings, and other key types get a dump by adding an
+ *  overload of their own next to the type.
+ */
+
+#ifndef RB_DUMP_H_
+#define RB_DUMP_H_
+
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+class RB_FdWriter
+{
+
+public:
+	explicit RB_FdWriter(int fd, size_t bufferSize = 1 << 20) : fd(fd), buffer(bufferSize), used(0), failed(false)
+	{
+	}
+
+	//Whatever is still buffered is lost if Flush was not called
+	~RB_FdWriter()
+	{
+	}
+
+	void Write(const void* data, size_t n)
+	{
+		const char* p = static_cast<const char*>(data);
+		while(n > 0)
+		{
+			if(used == buffer.size())
+				Flush();
+			size_t chunk = buffer.size() - used;
+			if(chunk > n)
+				chunk = n;
+			memcpy(&buffer[used], p, chunk);
+			used += chunk;
+			p += chunk;
+			n -= chunk;
+		}
+	}
+
+	void Put(char c)
+	{
+		if(used == buffer.size())
+			Flush();
+		buffer[used++] = c;
+	}
+
+	//Returns false if any write so far has failed
+	bool Flush()
+	{
+		size_t done = 0;
+		while(done < used && !failed)
+		{
+			ssize_t n = ::write(fd, &buffer[done], used - done);
+			if(n > 0)
+				done += n;
+			else if(n < 0 && errno == EINTR)
+				continue;
+			else
+				failed = true;
+		}
+		used = 0;
+		return !failed;
+	}
+
+private:
+	int fd;
+	std::vector<char> buffer;
+	size_t used;
+	bool failed;
+
+	RB_FdWriter(const RB_FdWriter&);
+	RB_FdWriter& operator=(const RB_FdWriter&);
+};
+
+//Decimal, written back to front into a scratch area and then copied out
+template <class Integer>
+typename std::enable_if<std::is_integral<Integer>::value>::type RB_FormatKey(RB_FdWriter& out, Integer key)
+{
+	char digits[24];
+	char* end = digits + sizeof(digits);
+	char* p = end;
+	typedef typename std::make_unsigned<Integer>::type Unsigned;
+	bool negative = key < 0;
+	//Negating in unsigned arithmetic also works for the most negative value
+	Unsigned value = negative ? (Unsigned) (0 - (Unsigned) key) : (Unsigned) key;
+	do
+	{
+		*--p = (char) ('0' + value % 10);
+		value /= 10;
+	} while(value != 0);
+	if(negative)
+		*--p = '-';
+	out.Write(p, end - p);
+}
+
+template <class Float>
+typename std::enable_if<std::is_floating_point<Float>::value>::type RB_FormatKey(RB_FdWriter& out, Float key)
+{
+	//Enough digits that the value reads back exactly
+	char text[32];
+	out.Write(text, snprintf(text, sizeof(text), "%.17g", (double) key));
+}
+
+inline void RB_FormatKey(RB_FdWriter& out, const std::string& key)
+{
+	out.Write(key.data(), key.size());
+}
+
+#endif /* RB_DUMP_H_ */
@@ -0,0 +1,256 @@
+/*
+ * RB_FrozenTree.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Read-only search array for tables that are built once and then only looked up.
+ *
+ *  The sorted keys are laid out in Eytzinger (breadth first) order: the root
+ *  is at index 1 and the children of node k are at 2k and 2k + 1.  A search
+ *  moves down with k = 2k + (key < probe), so there is no branch to
+ *  mispredict.  The first few levels share a handful of cache lines that stay
+ *  hot.  Below them, the 2^d descendants d levels under a node sit next to
+ *  each other.  Each step prefetches the line of descendants a whole cache
+ *  line's worth of levels ahead, so the misses of one search overlap instead
+ *  of coming one per level as they do in a pointer tree.
+ *
+ *  RB_LowerBoundBatch goes further and walks a group of searches down
+ *  together, level by level, so every step has a dozen misses in flight.
+ */
+
+#ifndef RB_FROZENTREE_H_
+#define RB_FROZENTREE_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <new>
+#include <functional>
+
+template <class Key, class Compare = std::less<Key> >
+class RB_FrozenTree
+{
+
+public:
+	RB_FrozenTree()
+	{
+		memory = NULL;
+		keys = NULL;
+		count = 0;
+		height = 0;
+	}
+
+	RB_FrozenTree(RB_FrozenTree&& other)
+	{
+		memory = other.memory;
+		keys = other.keys;
+		count = other.count;
+		height = other.height;
+		other.memory = NULL;
+		other.keys = NULL;
+		other.count = 0;
+		other.height = 0;
+	}
+
+	~RB_FrozenTree()
+	{
+		Release();
+	}
+
+	size_t RB_Size() const
+	{
+		return count;
+	}
+
+	bool RB_Empty() const
+	{
+		return count == 0;
+	}
+
+	//Replaces the contents with sorted[0..n), which must be in order
+	void RB_Build(const Key* sorted, size_t n)
+	{
+		RB_Build(n, [&sorted]() { return *sorted++; });
+	}
+
+	//Replaces the contents with n keys from next(), which must return them in order
+	template <class Source>
+	void RB_Build(size_t n, Source next)
+	{
+		Release();
+		if(n == 0)
+			return;
+
+		//Index 0 is unused but starts a line, so each block of FANOUT siblings fills one
+		memory = malloc((n + 1) * sizeof(Key) + LINE);
+		if(memory == NULL)
+			throw std::bad_alloc();
+		uintptr_t aligned = ((uintptr_t) memory + LINE - 1) & ~(uintptr_t) (LINE - 1);
+		keys = reinterpret_cast<Key*>(aligned);
+
+		//In-order walk of the implicit tree, filling each slot as it is reached.
+		//count stays 0 until every slot holds a key, so Release never destroys one
+		//that was not built.
+		size_t k = FirstInOrder(n);
+		size_t i = 0;
+		try
+		{
+			for(; i < n; i++)
+			{
+				new (&keys[k]) Key(next());
+				k = NextInOrder(k, n);
+			}
+		}
+		catch(...)
+		{
+			//The same walk again, over the keys built before the throw
+			k = FirstInOrder(n);
+			for(size_t j = 0; j < i; j++)
+			{
+				keys[k].~Key();
+				k = NextInOrder(k, n);
+			}
+			free(memory);
+			memory = NULL;
+			keys = NULL;
+			throw;
+		}
+
+		count = n;
+		height = 0;
+		while(((size_t) 2 << height) <= n + 1)
+			height++;
+	}
+
+	bool RB_Contains(const Key& key) const
+	{
+		const Key* found = RB_LowerBound(key);
+		return found != NULL && !less(key, *found);
+	}
+
+	//Smallest key not less than key, NULL if there is none
+	const Key* RB_LowerBound(const Key& key) const
+	{
+		size_t k = 1;
+		while(k <= count)
+		{
+			Prefetch(keys + k * FANOUT);
+			k = 2 * k + (less(keys[k], key) ? 1 : 0);
+		}
+		return Resolve(k);
+	}
+
+	/*
+	 * results[i] = RB_LowerBound(probes[i]) for i in [0, n).  The searches of
+	 * a group share every level: all of them step, then all of them step again.
+	 */
+	void RB_LowerBoundBatch(const Key* probes, size_t n, const Key** results) const
+	{
+		size_t k[GROUP];
+		for(size_t base = 0; base < n; base += GROUP)
+		{
+			size_t group = GROUP;
+			if(n - base < group)
+				group = n - base;
+			for(size_t j = 0; j < group; j++)
+				k[j] = 1;
+			//The top height levels are full, so no index can run off the end there
+			for(unsigned level = 0; level < height; level++)
+			{
+				for(size_t j = 0; j < group; j++)
+				{
+					Prefetch(keys + k[j] * FANOUT);
+					k[j] = 2 * k[j] + (less(keys[k[j]], probes[base + j]) ? 1 : 0);
+				}
+			}
+			for(size_t j = 0; j < group; j++)
+			{
+				if(k[j] <= count)
+					k[j] = 2 * k[j] + (less(keys[k[j]], probes[base + j]) ? 1 : 0);
+				results[base + j] = Resolve(k[j]);
+			}
+		}
+	}
+
+	//Bytes held by the key array
+	size_t RB_BytesUsed() const
+	{
+		return memory == NULL ? 0 : (count + 1) * sizeof(Key) + LINE;
+	}
+
+private:
+	static const size_t LINE = 64;
+	//Searches walked down together by RB_LowerBoundBatch
+	static const size_t GROUP = 16;
+
+	//Keys per line, rounded down to a power of two.  Node k's descendants
+	//log2(FANOUT) levels down start at k * FANOUT and fill one line.
+	static const size_t FANOUT = sizeof(Key) > LINE / 2 ? 1 : sizeof(Key) > LINE / 4 ? 2 : sizeof(Key) > LINE / 8 ? 4 : sizeof(Key) > LINE / 16 ? 8 : 16;
+
+	void* memory;
+	Key* keys;
+	size_t count;
+	//Full levels in the implicit tree, below them is at most one partial level
+	unsigned height;
+	Compare less;
+
+	RB_FrozenTree(const RB_FrozenTree&);
+	RB_FrozenTree& operator=(const RB_FrozenTree&);
+
+	static void Prefetch(const void* p)
+	{
+#ifdef __GNUC__
+		__builtin_prefetch(p);
+#endif
+	}
+
+	//Slot of the smallest key in an implicit tree of n
+	static size_t FirstInOrder(size_t n)
+	{
+		size_t k = 1;
+		while(2 * k <= n)
+			k = 2 * k;
+		return k;
+	}
+
+	//Slot of the key after the one in slot k, 0 past the largest
+	static size_t NextInOrder(size_t k, size_t n)
+	{
+		if(2 * k + 1 <= n)
+		{
+			k = 2 * k + 1;
+			while(2 * k <= n)
+				k = 2 * k;
+			return k;
+		}
+		//Climb past every right child, then once more
+		while(k & 1)
+			k >>= 1;
+		return k >> 1;
+	}
+
+	/*
+	 * k walked off the bottom of the tree.  Its low one bits are the right
+	 * turns since the last left turn, and that node is the answer.  k is 0
+	 * when every key was less than the probe.
+	 */
+	const Key* Resolve(size_t k) const
+	{
+		while(k & 1)
+			k >>= 1;
+		k >>= 1;
+		return k == 0 ? NULL : &keys[k];
+	}
+
+	void Release()
+	{
+		for(size_t k = 1; k <= count; k++)
+			keys[k].~Key();
+		free(memory);
+		memory = NULL;
+		keys = NULL;
+		count = 0;
+		height = 0;
+	}
+};
+
+#endif /* RB_FROZENTREE_H_ */
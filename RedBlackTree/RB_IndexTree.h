@@ -0,0 +1,556 @@
+/*
+ * RB_IndexTree.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Compact red-black set whose nodes live in one contiguous array.
+ *
+ *  Links are 32 bit indices into the array instead of pointers, and the color
+ *  is the low bit of the parent index, so a node is 12 bytes of links plus the
+ *  key: 16 bytes for an int where an RB_Set entry takes 32.  Nothing in the
+ *  array depends on where it is in memory, so growing it is a plain copy and
+ *  RB_Save/RB_Load write and read the tree as it is.
+ *
+ *  Same algorithms as RB_Tree (CLRS chapter 13), with NIL in place of NULL.
+ *  Deleted slots are chained through their left link and reused by the next
+ *  insert.  Keys must be trivially copyable.
+ */
+
+#ifndef RB_INDEXTREE_H_
+#define RB_INDEXTREE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <functional>
+#include <type_traits>
+#include <stdexcept>
+#include "RB_Node.h"
+
+template <class Key, class Compare = std::less<Key> >
+class RB_IndexTree
+{
+
+public:
+	//Marks a missing link, also the limit on the number of nodes
+	static const uint32_t NIL = 0x7FFFFFFF;
+
+	RB_IndexTree()
+	{
+		root = NIL;
+		freeHead = NIL;
+		count = 0;
+	}
+
+	size_t RB_Size() const
+	{
+		return count;
+	}
+
+	bool RB_Empty() const
+	{
+		return count == 0;
+	}
+
+	//Makes room for n nodes up front so building the tree never moves the array
+	void RB_Reserve(size_t n)
+	{
+		nodes.reserve(n);
+	}
+
+	//Bytes held by the node array
+	size_t RB_BytesUsed() const
+	{
+		return nodes.capacity() * sizeof(Node);
+	}
+
+	//Returns false if key was already present
+	bool RB_Insert(const Key& key)
+	{
+		uint32_t y = NIL;
+		uint32_t x = root;
+		bool goLeft = false;
+		while(x != NIL)
+		{
+			y = x;
+			if(less(key, nodes[x].key))
+			{
+				goLeft = true;
+				x = nodes[x].left;
+			}
+			else if(less(nodes[x].key, key))
+			{
+				goLeft = false;
+				x = nodes[x].right;
+			}
+			else
+				return false;
+		}
+
+		uint32_t z = Allocate(key);
+		SetParent(z, y);
+		if(y == NIL)
+			root = z;
+		else if(goLeft)
+			nodes[y].left = z;
+		else
+			nodes[y].right = z;
+		count++;
+		RB_Insert_Fixup(z);
+		return true;
+	}
+
+	//Returns false if key was not present
+	bool RB_Delete(const Key& key)
+	{
+		uint32_t z = Find(key);
+		if(z == NIL)
+			return false;
+
+		uint32_t y = z;
+		COLOR yOriginalColor = Color(y);
+		uint32_t x;
+		uint32_t xParent;
+		if(nodes[z].left == NIL)
+		{
+			x = nodes[z].right;
+			xParent = Parent(z);
+			Transplant(z, x);
+		}
+		else if(nodes[z].right == NIL)
+		{
+			x = nodes[z].left;
+			xParent = Parent(z);
+			Transplant(z, x);
+		}
+		else
+		{
+			y = Minimum(nodes[z].right);
+			yOriginalColor = Color(y);
+			x = nodes[y].right;
+			if(Parent(y) == z)
+				xParent = y;
+			else
+			{
+				xParent = Parent(y);
+				Transplant(y, x);
+				nodes[y].right = nodes[z].right;
+				SetParent(nodes[y].right, y);
+			}
+			Transplant(z, y);
+			nodes[y].left = nodes[z].left;
+			SetParent(nodes[y].left, y);
+			SetColor(y, Color(z));
+		}
+		count--;
+		if(yOriginalColor == BLACK)
+			RB_Delete_Fixup(x, xParent);
+
+		nodes[z].left = freeHead;
+		freeHead = z;
+		return true;
+	}
+
+	bool RB_Contains(const Key& key) const
+	{
+		return Find(key) != NIL;
+	}
+
+	//Smallest key not less than key, NULL if there is none
+	const Key* RB_LowerBound(const Key& key) const
+	{
+		uint32_t x = root;
+		uint32_t result = NIL;
+		while(x != NIL)
+		{
+			if(less(nodes[x].key, key))
+				x = nodes[x].right;
+			else
+			{
+				result = x;
+				x = nodes[x].left;
+			}
+		}
+		return result == NIL ? NULL : &nodes[result].key;
+	}
+
+	void RB_Clear()
+	{
+		nodes.clear();
+		root = NIL;
+		freeHead = NIL;
+		count = 0;
+	}
+
+	//Writes the tree to out as raw memory, returns false on a write error
+	bool RB_Save(FILE* out) const
+	{
+		Header h;
+		h.magic = MAGIC;
+		h.nodeSize = sizeof(Node);
+		h.root = root;
+		h.freeHead = freeHead;
+		h.count = count;
+		h.slots = nodes.size();
+		if(fwrite(&h, sizeof(h), 1, out) != 1)
+			return false;
+		return nodes.empty() || fwrite(&nodes[0], sizeof(Node), nodes.size(), out) == nodes.size();
+	}
+
+	//Replaces the tree with one written by RB_Save, returns false if in does not hold one.
+	//The tree is left as it was when the file is short or its links do not form a valid tree.
+	bool RB_Load(FILE* in)
+	{
+		Header h;
+		if(fread(&h, sizeof(h), 1, in) != 1 || h.magic != MAGIC || h.nodeSize != sizeof(Node) || h.slots > NIL)
+			return false;
+		//Read in chunks so a damaged slot count runs out of file before it runs out of memory
+		std::vector<Node> loaded;
+		while(loaded.size() < h.slots)
+		{
+			size_t have = loaded.size();
+			size_t chunk = h.slots - have < 65536 ? (size_t) (h.slots - have) : 65536;
+			loaded.resize(have + chunk);
+			if(fread(&loaded[have], sizeof(Node), chunk, in) != chunk)
+				return false;
+		}
+		if(!Valid(loaded, h))
+			return false;
+		nodes.swap(loaded);
+		root = h.root;
+		freeHead = h.freeHead;
+		count = h.count;
+		return true;
+	}
+
+private:
+	static_assert(std::is_trivially_copyable<Key>::value, "RB_IndexTree keys are copied as raw memory");
+
+	static const uint32_t MAGIC = 0x52424958;
+
+	struct Node
+	{
+		uint32_t left;
+		uint32_t right;
+		//Parent index shifted up one, the low bit is the color
+		uint32_t parentAndColor;
+		Key key;
+	};
+
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t nodeSize;
+		uint32_t root;
+		uint32_t freeHead;
+		uint64_t count;
+		uint64_t slots;
+	};
+
+	std::vector<Node> nodes;
+	uint32_t root;
+	//Deleted slots, linked through left
+	uint32_t freeHead;
+	size_t count;
+	Compare less;
+
+	/*
+	 * Checks a loaded array before it replaces the tree: every link is in range,
+	 * the links from root form a red-black tree with consistent parents holding
+	 * h.count nodes, and the free chain holds every other slot exactly once.
+	 * Key order is not checked, a file with keys out of order only gives wrong answers.
+	 */
+	static bool Valid(const std::vector<Node>& n, const Header& h)
+	{
+		uint64_t slots = h.slots;
+		if((h.root != NIL && h.root >= slots) || (h.freeHead != NIL && h.freeHead >= slots) || h.count > slots)
+			return false;
+		for(uint64_t i = 0; i < slots; i++)
+		{
+			uint32_t parent = n[i].parentAndColor >> 1;
+			if((n[i].left != NIL && n[i].left >= slots) || (n[i].right != NIL && n[i].right >= slots) || (parent != NIL && parent >= slots))
+				return false;
+		}
+
+		//Walk the tree with an explicit stack, the black count of the path comes along
+		std::vector<char> seen(slots, 0);
+		uint64_t treeNodes = 0;
+		int blackHeight = -1;
+		if(h.root != NIL && ((n[h.root].parentAndColor >> 1) != NIL || (COLOR) (n[h.root].parentAndColor & 1) != BLACK))
+			return false;
+		std::vector<std::pair<uint32_t, int> > stack;
+		stack.push_back(std::make_pair(h.root, 0));
+		while(!stack.empty())
+		{
+			uint32_t x = stack.back().first;
+			int blacks = stack.back().second;
+			stack.pop_back();
+			if(x == NIL)
+			{
+				if(blackHeight == -1)
+					blackHeight = blacks;
+				else if(blackHeight != blacks)
+					return false;
+				continue;
+			}
+			if(seen[x])
+				return false;
+			seen[x] = 1;
+			treeNodes++;
+			bool red = (COLOR) (n[x].parentAndColor & 1) == RED;
+			if(!red)
+				blacks++;
+			uint32_t children[2] = { n[x].left, n[x].right };
+			for(int c = 0; c < 2; c++)
+			{
+				uint32_t y = children[c];
+				if(y != NIL && ((n[y].parentAndColor >> 1) != x || (red && (COLOR) (n[y].parentAndColor & 1) == RED)))
+					return false;
+				stack.push_back(std::make_pair(y, blacks));
+			}
+		}
+		if(treeNodes != h.count)
+			return false;
+
+		uint64_t freeNodes = 0;
+		for(uint32_t x = h.freeHead; x != NIL; x = n[x].left)
+		{
+			if(seen[x])
+				return false;
+			seen[x] = 1;
+			freeNodes++;
+		}
+		return treeNodes + freeNodes == slots;
+	}
+
+	uint32_t Parent(uint32_t x) const { return nodes[x].parentAndColor >> 1; }
+	void SetParent(uint32_t x, uint32_t p) { nodes[x].parentAndColor = (p << 1) | (nodes[x].parentAndColor & 1); }
+	COLOR Color(uint32_t x) const { return (COLOR) (nodes[x].parentAndColor & 1); }
+	void SetColor(uint32_t x, COLOR c) { nodes[x].parentAndColor = (nodes[x].parentAndColor & ~1u) | (uint32_t) c; }
+	bool IsRed(uint32_t x) const { return x != NIL && Color(x) == RED; }
+
+	//A fresh red leaf holding key, from the free chain if there is a slot
+	uint32_t Allocate(const Key& key)
+	{
+		uint32_t z = freeHead;
+		if(z != NIL)
+			freeHead = nodes[z].left;
+		else
+		{
+			if(nodes.size() >= NIL)
+				throw std::length_error("RB_IndexTree is full");
+			z = (uint32_t) nodes.size();
+			nodes.push_back(Node());
+		}
+		//Padding too, RB_Save writes the node as it is
+		memset(&nodes[z], 0, sizeof(Node));
+		nodes[z].left = NIL;
+		nodes[z].right = NIL;
+		nodes[z].parentAndColor = (NIL << 1) | RED;
+		nodes[z].key = key;
+		return z;
+	}
+
+	uint32_t Find(const Key& key) const
+	{
+		uint32_t x = root;
+		while(x != NIL)
+		{
+			if(less(key, nodes[x].key))
+				x = nodes[x].left;
+			else if(less(nodes[x].key, key))
+				x = nodes[x].right;
+			else
+				return x;
+		}
+		return NIL;
+	}
+
+	uint32_t Minimum(uint32_t x) const
+	{
+		while(nodes[x].left != NIL)
+			x = nodes[x].left;
+		return x;
+	}
+
+	void Transplant(uint32_t u, uint32_t v)
+	{
+		uint32_t p = Parent(u);
+		if(p == NIL)
+			root = v;
+		else if(u == nodes[p].left)
+			nodes[p].left = v;
+		else
+			nodes[p].right = v;
+		if(v != NIL)
+			SetParent(v, p);
+	}
+
+	void Left_Rotate(uint32_t x)
+	{
+		uint32_t y = nodes[x].right;
+		nodes[x].right = nodes[y].left;
+		if(nodes[y].left != NIL)
+			SetParent(nodes[y].left, x);
+		uint32_t p = Parent(x);
+		SetParent(y, p);
+		if(p == NIL)
+			root = y;
+		else if(x == nodes[p].left)
+			nodes[p].left = y;
+		else
+			nodes[p].right = y;
+		nodes[y].left = x;
+		SetParent(x, y);
+	}
+
+	void Right_Rotate(uint32_t x)
+	{
+		uint32_t y = nodes[x].left;
+		nodes[x].left = nodes[y].right;
+		if(nodes[y].right != NIL)
+			SetParent(nodes[y].right, x);
+		uint32_t p = Parent(x);
+		SetParent(y, p);
+		if(p == NIL)
+			root = y;
+		else if(x == nodes[p].right)
+			nodes[p].right = y;
+		else
+			nodes[p].left = y;
+		nodes[y].right = x;
+		SetParent(x, y);
+	}
+
+	void RB_Insert_Fixup(uint32_t z)
+	{
+		while(IsRed(Parent(z)))
+		{
+			uint32_t parent = Parent(z);
+			uint32_t grandparent = Parent(parent);
+			if(parent == nodes[grandparent].left)
+			{
+				uint32_t y = nodes[grandparent].right;
+				if(IsRed(y))
+				{
+					SetColor(parent, BLACK);
+					SetColor(y, BLACK);
+					SetColor(grandparent, RED);
+					z = grandparent;
+				}
+				else
+				{
+					if(z == nodes[parent].right)
+					{
+						z = parent;
+						Left_Rotate(z);
+						parent = Parent(z);
+					}
+					SetColor(parent, BLACK);
+					SetColor(grandparent, RED);
+					Right_Rotate(grandparent);
+				}
+			}
+			else
+			{
+				uint32_t y = nodes[grandparent].left;
+				if(IsRed(y))
+				{
+					SetColor(parent, BLACK);
+					SetColor(y, BLACK);
+					SetColor(grandparent, RED);
+					z = grandparent;
+				}
+				else
+				{
+					if(z == nodes[parent].left)
+					{
+						z = parent;
+						Right_Rotate(z);
+						parent = Parent(z);
+					}
+					SetColor(parent, BLACK);
+					SetColor(grandparent, RED);
+					Left_Rotate(grandparent);
+				}
+			}
+		}
+		SetColor(root, BLACK);
+	}
+
+	void RB_Delete_Fixup(uint32_t x, uint32_t parent)
+	{
+		while(x != root && !IsRed(x))
+		{
+			if(x == nodes[parent].left)
+			{
+				uint32_t w = nodes[parent].right;
+				if(IsRed(w))
+				{
+					SetColor(w, BLACK);
+					SetColor(parent, RED);
+					Left_Rotate(parent);
+					w = nodes[parent].right;
+				}
+				if(!IsRed(nodes[w].left) && !IsRed(nodes[w].right))
+				{
+					SetColor(w, RED);
+					x = parent;
+					parent = Parent(x);
+				}
+				else
+				{
+					if(!IsRed(nodes[w].right))
+					{
+						SetColor(nodes[w].left, BLACK);
+						SetColor(w, RED);
+						Right_Rotate(w);
+						w = nodes[parent].right;
+					}
+					SetColor(w, Color(parent));
+					SetColor(parent, BLACK);
+					SetColor(nodes[w].right, BLACK);
+					Left_Rotate(parent);
+					x = root;
+				}
+			}
+			else
+			{
+				uint32_t w = nodes[parent].left;
+				if(IsRed(w))
+				{
+					SetColor(w, BLACK);
+					SetColor(parent, RED);
+					Right_Rotate(parent);
+					w = nodes[parent].left;
+				}
+				if(!IsRed(nodes[w].left) && !IsRed(nodes[w].right))
+				{
+					SetColor(w, RED);
+					x = parent;
+					parent = Parent(x);
+				}
+				else
+				{
+					if(!IsRed(nodes[w].left))
+					{
+						SetColor(nodes[w].right, BLACK);
+						SetColor(w, RED);
+						Left_Rotate(w);
+						w = nodes[parent].left;
+					}
+					SetColor(w, Color(parent));
+					SetColor(parent, BLACK);
+					SetColor(nodes[w].left, BLACK);
+					Right_Rotate(parent);
+					x = root;
+				}
+			}
+		}
+		if(x != NIL)
+			SetColor(x, BLACK);
+	}
+};
+
+#endif /* RB_INDEXTREE_H_ */
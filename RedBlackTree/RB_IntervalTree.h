@@ -0,0 +1,187 @@
+/*
+ * RB_IntervalTree.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Interval tree (CLRS section 14.3) on top of RB_Tree.
+ *
+ *  Nodes hold a closed interval [low, high], are ordered by low, and record the
+ *  largest high anywhere in their subtree.  RB_Tree keeps that maximum right
+ *  through rotations, inserts and deletes by calling the traits' Update.  A
+ *  query skips every subtree whose maximum ends before the query starts, and
+ *  every right subtree once the query ends before a node's low, so it costs
+ *  O(log n + k) for k matches in practice.
+ */
+
+#ifndef RB_INTERVALTREE_H_
+#define RB_INTERVALTREE_H_
+
+#include <vector>
+#include "RB_Tree.h"
+
+//Hook for nodes of an RB_IntervalTree, E is the endpoint type
+template <class E>
+class RB_IntervalNode : public RB_Node
+{
+
+public:
+	RB_IntervalNode(const E& l, const E& h) : low(l), high(h), maxHigh(h) {}
+
+	E low;
+	E high;
+	//Largest high in the subtree rooted here
+	E maxHigh;
+};
+
+template <class T, class E>
+struct RB_IntervalTraits
+{
+	typedef E Key;
+	static const bool AUGMENTED = true;
+
+	static const Key& KeyOf(const RB_Node* n) { return static_cast<const T*>(n)->low; }
+	static bool Less(const Key& a, const Key& b) { return a < b; }
+
+	static void Update(RB_Node* n)
+	{
+		T* x = static_cast<T*>(n);
+		x->maxHigh = x->high;
+		if(n->left != NULL && x->maxHigh < static_cast<T*>(n->left)->maxHigh)
+			x->maxHigh = static_cast<T*>(n->left)->maxHigh;
+		if(n->right != NULL && x->maxHigh < static_cast<T*>(n->right)->maxHigh)
+			x->maxHigh = static_cast<T*>(n->right)->maxHigh;
+	}
+};
+
+/*
+ * Intrusive like RB_Tree, over nodes of type T that derive from
+ * RB_IntervalNode<E>.  Any number of nodes may share the same interval.
+ */
+template <class T, class E = int>
+class RB_IntervalTree : public RB_Tree<T, RB_IntervalTraits<T, E> >
+{
+
+public:
+	//Some interval overlapping [lo, hi], NULL if there is none
+	T* RB_OverlapAny(const E& lo, const E& hi)
+	{
+		RB_Node* x = this->RB_GetRoot();
+		while(x != NULL && !Overlaps(Node(x), lo, hi))
+		{
+			//If anything on the left reaches lo, the lowest such interval starts
+			//no later than hi or nothing on the right could overlap either
+			if(x->left != NULL && !(Node(x->left)->maxHigh < lo))
+				x = x->left;
+			else
+				x = x->right;
+		}
+		return static_cast<T*>(x);
+	}
+
+	//Calls visit(node) for every interval overlapping [lo, hi], in order of low
+	template <class Visitor>
+	void RB_Overlap(const E& lo, const E& hi, Visitor visit)
+	{
+		Overlap(this->RB_GetRoot(), lo, hi, visit);
+	}
+
+	//Calls visit(node) for every interval that contains point
+	template <class Visitor>
+	void RB_Stab(const E& point, Visitor visit)
+	{
+		Overlap(this->RB_GetRoot(), point, point, visit);
+	}
+
+	/*
+	 * Answers n overlap queries [lo[i], hi[i]] in one walk of the tree, calling
+	 * visit(i, node) for every match.  Each node is visited once for all the
+	 * queries that can still reach it instead of once per query, which pays off
+	 * when the queries are many and close together.
+	 */
+	template <class Visitor>
+	void RB_OverlapBatch(const E* lo, const E* hi, size_t n, Visitor visit)
+	{
+		if(n == 0 || this->RB_GetRoot() == NULL)
+			return;
+		std::vector<size_t> active;
+		active.reserve(n * 2);
+		for(size_t i = 0; i < n; i++)
+		{
+			if(!(Node(this->RB_GetRoot())->maxHigh < lo[i]))
+				active.push_back(i);
+		}
+		Batch(this->RB_GetRoot(), active, 0, active.size(), lo, hi, visit);
+	}
+
+private:
+	static T* Node(RB_Node* n) { return static_cast<T*>(n); }
+
+	static bool Overlaps(const T* x, const E& lo, const E& hi)
+	{
+		return !(hi < x->low) && !(x->high < lo);
+	}
+
+	template <class Visitor>
+	static void Overlap(RB_Node* x, const E& lo, const E& hi, Visitor& visit)
+	{
+		//Recursion depth is the tree height, at most 2 log n
+		while(x != NULL && !(Node(x)->maxHigh < lo))
+		{
+			Overlap(x->left, lo, hi, visit);
+			//Everything from here right starts after hi
+			if(hi < Node(x)->low)
+				return;
+			if(!(Node(x)->high < lo))
+				visit(Node(x));
+			x = x->right;
+		}
+	}
+
+	/*
+	 * active[begin, end) are the queries that can overlap something under x.
+	 * Each child gets the ones that can still reach it appended past end and
+	 * trimmed off again afterwards, so the list works as a stack.
+	 */
+	template <class Visitor>
+	static void Batch(RB_Node* x, std::vector<size_t>& active, size_t begin, size_t end, const E* lo, const E* hi, Visitor& visit)
+	{
+		RB_Node* left = x->left;
+		if(left != NULL)
+		{
+			size_t mark = active.size();
+			for(size_t i = begin; i < end; i++)
+			{
+				size_t q = active[i];
+				if(!(Node(left)->maxHigh < lo[q]))
+					active.push_back(q);
+			}
+			if(active.size() > mark)
+				Batch(left, active, mark, active.size(), lo, hi, visit);
+			active.resize(mark);
+		}
+
+		for(size_t i = begin; i < end; i++)
+		{
+			size_t q = active[i];
+			if(Overlaps(Node(x), lo[q], hi[q]))
+				visit(q, Node(x));
+		}
+
+		RB_Node* right = x->right;
+		if(right != NULL)
+		{
+			size_t mark = active.size();
+			for(size_t i = begin; i < end; i++)
+			{
+				size_t q = active[i];
+				if(!(hi[q] < Node(x)->low) && !(Node(right)->maxHigh < lo[q]))
+					active.push_back(q);
+			}
+			if(active.size() > mark)
+				Batch(right, active, mark, active.size(), lo, hi, visit);
+			active.resize(mark);
+		}
+	}
+};
+
+#endif /* RB_INTERVALTREE_H_ */
@@ -0,0 +1,533 @@
+/*
+ * RB_Join.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Join based split, join and bulk set operations for RB_Tree.
+ *
+ *  Everything here is built on one primitive, join(L, k, R), which links two
+ *  red-black trees and a middle node whose key lies between them in time
+ *  proportional to the difference in their black heights.  Split walks one
+ *  path and joins the pieces back up.  Union, intersection and difference
+ *  split one tree by the other's root, recurse on both sides and join the
+ *  results (Blelloch, Ferizovic and Sun, "Just Join for Parallel Ordered
+ *  Sets", SPAA 2016).  That takes O(m log(n/m + 1)) work for trees of size
+ *  m <= n, and the two recursive calls are independent, so large ones run on
+ *  their own threads for O(log^2 n) depth.  The sorted build is split the same
+ *  way.
+ *
+ *  The trees are intrusive, so the operations only relink nodes.  Nodes that
+ *  drop out of a result (the second copy of a key in a union, everything not
+ *  in both trees for an intersection) are handed to a dispose(T*) callback.
+ *  With more than one thread dispose can be called from several threads at
+ *  once.  Keys must be unique within each tree.
+ */
+
+#ifndef RB_JOIN_H_
+#define RB_JOIN_H_
+
+#include <thread>
+#include <atomic>
+#include "RB_Tree.h"
+
+template <class T, class Traits>
+class RB_JoinOps
+{
+
+public:
+	typedef RB_Tree<T, Traits> Tree;
+	typedef typename Traits::Key Key;
+
+	//Upper bound on threads used by the set operations and the sorted build
+	static unsigned& Threads()
+	{
+		static unsigned threads = std::thread::hardware_concurrency() == 0 ? 1 : std::thread::hardware_concurrency();
+		return threads;
+	}
+
+	static void Join(Tree& left, T* k, Tree& right)
+	{
+		size_t total = Tree::UNKNOWN_COUNT;
+		if(left.count != Tree::UNKNOWN_COUNT && right.count != Tree::UNKNOWN_COUNT)
+			total = left.count + 1 + right.count;
+		Finish(left, Link(Whole(left), k, Whole(right)), total);
+		right.RB_Clear();
+	}
+
+	static T* Split(Tree& tree, const Key& key, Tree& right)
+	{
+		Sub l;
+		Sub r;
+		RB_Node* middle;
+		SplitAt(Whole(tree), key, l, middle, r);
+		Finish(tree, l, Tree::UNKNOWN_COUNT);
+		Finish(right, r, Tree::UNKNOWN_COUNT);
+		if(middle != NULL)
+			Detach(middle);
+		return static_cast<T*>(middle);
+	}
+
+	template <class Dispose>
+	static void Union(Tree& a, Tree& b, Dispose dispose)
+	{
+		std::atomic<size_t> disposed(0);
+		size_t total = Total(a, b);
+		Sub result = UnionOf(Whole(a), Whole(b), dispose, disposed, ForkBudget());
+		Finish(a, result, total == Tree::UNKNOWN_COUNT ? total : total - disposed.load());
+		b.RB_Clear();
+	}
+
+	template <class Dispose>
+	static void Intersection(Tree& a, Tree& b, Dispose dispose)
+	{
+		std::atomic<size_t> disposed(0);
+		size_t total = Total(a, b);
+		Sub result = IntersectionOf(Whole(a), Whole(b), dispose, disposed, ForkBudget());
+		Finish(a, result, total == Tree::UNKNOWN_COUNT ? total : total - disposed.load());
+		b.RB_Clear();
+	}
+
+	template <class Dispose>
+	static void Difference(Tree& a, Tree& b, Dispose dispose)
+	{
+		std::atomic<size_t> disposed(0);
+		size_t total = Total(a, b);
+		Sub result = DifferenceOf(Whole(a), Whole(b), dispose, disposed, ForkBudget());
+		Finish(a, result, total == Tree::UNKNOWN_COUNT ? total : total - disposed.load());
+		b.RB_Clear();
+	}
+
+	static void BuildSorted(Tree& tree, T** nodes, size_t n)
+	{
+		//Every level above the last full one is black, a partial last level is red
+		int fullLevels = 0;
+		while(((size_t) 2 << fullLevels) - 1 <= n)
+			fullLevels++;
+		RB_Node* root = Build(nodes, 0, n, 0, fullLevels, ForkBudget());
+		Sub whole = { root, fullLevels };
+		Finish(tree, whole, n);
+	}
+
+private:
+	//A subtree with its black height, the black nodes on any path down to NULL
+	struct Sub
+	{
+		RB_Node* root;
+		int bh;
+	};
+
+	//Only recurse on a new thread when the subtree has at least 2^PARALLEL_BH nodes
+	static const int PARALLEL_BH = 11;
+
+	static int ForkBudget()
+	{
+		int budget = 0;
+		while((1u << budget) < Threads())
+			budget++;
+		//One level more than the threads, so an uneven split still keeps them busy
+		return budget == 0 ? 0 : budget + 1;
+	}
+
+	template <class F, class G>
+	static void Fork(bool parallel, F f, G g)
+	{
+		if(parallel)
+		{
+			std::thread other(f);
+			g();
+			other.join();
+		}
+		else
+		{
+			f();
+			g();
+		}
+	}
+
+	static int BlackHeight(const RB_Node* x)
+	{
+		int bh = 0;
+		for(; x != NULL; x = x->left)
+			bh += RB_IsRed(x) ? 0 : 1;
+		return bh;
+	}
+
+	static Sub Whole(Tree& tree)
+	{
+		Sub s = { tree.root, BlackHeight(tree.root) };
+		return s;
+	}
+
+	static size_t Total(const Tree& a, const Tree& b)
+	{
+		if(a.count == Tree::UNKNOWN_COUNT || b.count == Tree::UNKNOWN_COUNT)
+			return Tree::UNKNOWN_COUNT;
+		return a.count + b.count;
+	}
+
+	//Installs s as the whole of tree, the root of a tree is always black
+	static void Finish(Tree& tree, Sub s, size_t count)
+	{
+		tree.root = s.root;
+		tree.count = count;
+		if(s.root != NULL)
+		{
+			s.root->SetParent(NULL);
+			s.root->SetColor(BLACK);
+		}
+	}
+
+	static void Detach(RB_Node* x)
+	{
+		x->left = NULL;
+		x->right = NULL;
+		x->SetParent(NULL);
+	}
+
+	static int ChildHeight(const RB_Node* x, int bh)
+	{
+		return RB_IsRed(x) ? bh : bh - 1;
+	}
+
+	static void Attach(RB_Node* x, RB_Node* l, RB_Node* r)
+	{
+		x->left = l;
+		x->right = r;
+		if(l != NULL)
+			l->SetParent(x);
+		if(r != NULL)
+			r->SetParent(x);
+		if(Traits::AUGMENTED)
+			Traits::Update(x);
+	}
+
+	static RB_Node* RotateLeft(RB_Node* x)
+	{
+		RB_Node* y = x->right;
+		Attach(x, x->left, y->left);
+		Attach(y, x, y->right);
+		return y;
+	}
+
+	static RB_Node* RotateRight(RB_Node* x)
+	{
+		RB_Node* y = x->left;
+		Attach(x, y->right, x->right);
+		Attach(y, y->left, x);
+		return y;
+	}
+
+	//Hangs k and r off the right spine of l, where l is the taller tree
+	static RB_Node* JoinRight(RB_Node* l, int lbh, RB_Node* k, RB_Node* r, int rbh)
+	{
+		if(!RB_IsRed(l) && lbh == rbh)
+		{
+			k->SetColor(RED);
+			Attach(k, l, r);
+			return k;
+		}
+		RB_Node* joined = JoinRight(l->right, ChildHeight(l, lbh), k, r, rbh);
+		Attach(l, l->left, joined);
+		if(!RB_IsRed(l) && RB_IsRed(l->right) && RB_IsRed(l->right->right))
+		{
+			l->right->right->SetColor(BLACK);
+			return RotateLeft(l);
+		}
+		return l;
+	}
+
+	static RB_Node* JoinLeft(RB_Node* l, int lbh, RB_Node* k, RB_Node* r, int rbh)
+	{
+		if(!RB_IsRed(r) && lbh == rbh)
+		{
+			k->SetColor(RED);
+			Attach(k, l, r);
+			return k;
+		}
+		RB_Node* joined = JoinLeft(l, lbh, k, r->left, ChildHeight(r, rbh));
+		Attach(r, joined, r->right);
+		if(!RB_IsRed(r) && RB_IsRed(r->left) && RB_IsRed(r->left->left))
+		{
+			r->left->left->SetColor(BLACK);
+			return RotateRight(r);
+		}
+		return r;
+	}
+
+	//join(l, k, r), every key in l is less than k's and every key in r greater
+	static Sub Link(Sub l, RB_Node* k, Sub r)
+	{
+		Sub s;
+		if(l.bh > r.bh)
+		{
+			s.root = JoinRight(l.root, l.bh, k, r.root, r.bh);
+			s.bh = l.bh;
+			if(RB_IsRed(s.root) && RB_IsRed(s.root->right))
+			{
+				s.root->SetColor(BLACK);
+				s.bh++;
+			}
+		}
+		else if(r.bh > l.bh)
+		{
+			s.root = JoinLeft(l.root, l.bh, k, r.root, r.bh);
+			s.bh = r.bh;
+			if(RB_IsRed(s.root) && RB_IsRed(s.root->left))
+			{
+				s.root->SetColor(BLACK);
+				s.bh++;
+			}
+		}
+		else
+		{
+			bool red = !RB_IsRed(l.root) && !RB_IsRed(r.root);
+			k->SetColor(red ? RED : BLACK);
+			Attach(k, l.root, r.root);
+			s.root = k;
+			s.bh = red ? l.bh : l.bh + 1;
+		}
+		return s;
+	}
+
+	//Keys less than key go to l, greater to r, an equal node comes back in middle
+	static void SplitAt(Sub t, const Key& key, Sub& l, RB_Node*& middle, Sub& r)
+	{
+		if(t.root == NULL)
+		{
+			l = t;
+			r = t;
+			middle = NULL;
+			return;
+		}
+		RB_Node* x = t.root;
+		int cbh = ChildHeight(x, t.bh);
+		Sub left = { x->left, cbh };
+		Sub right = { x->right, cbh };
+		if(Traits::Less(key, Traits::KeyOf(x)))
+		{
+			SplitAt(left, key, l, middle, r);
+			r = Link(r, x, right);
+		}
+		else if(Traits::Less(Traits::KeyOf(x), key))
+		{
+			SplitAt(right, key, l, middle, r);
+			l = Link(left, x, l);
+		}
+		else
+		{
+			l = left;
+			r = right;
+			middle = x;
+		}
+	}
+
+	//Takes the largest node out of t, which must not be empty
+	static RB_Node* SplitLast(Sub t, Sub& rest)
+	{
+		RB_Node* x = t.root;
+		int cbh = ChildHeight(x, t.bh);
+		Sub left = { x->left, cbh };
+		if(x->right == NULL)
+		{
+			rest = left;
+			return x;
+		}
+		Sub right = { x->right, cbh };
+		Sub remaining;
+		RB_Node* last = SplitLast(right, remaining);
+		rest = Link(left, x, remaining);
+		return last;
+	}
+
+	//join(l, r) without a middle node
+	static Sub Concat(Sub l, Sub r)
+	{
+		if(l.root == NULL)
+			return r;
+		Sub rest;
+		RB_Node* last = SplitLast(l, rest);
+		return Link(rest, last, r);
+	}
+
+	template <class Dispose>
+	static void Drop(RB_Node* x, Dispose& dispose, std::atomic<size_t>& disposed)
+	{
+		Detach(x);
+		dispose(static_cast<T*>(x));
+		disposed++;
+	}
+
+	//Hands every node under x to dispose, rotating left children up so no stack is needed
+	template <class Dispose>
+	static void DropAll(RB_Node* x, Dispose& dispose, std::atomic<size_t>& disposed)
+	{
+		while(x != NULL)
+		{
+			if(x->left != NULL)
+			{
+				RB_Node* l = x->left;
+				x->left = l->right;
+				l->right = x;
+				x = l;
+			}
+			else
+			{
+				RB_Node* next = x->right;
+				Drop(x, dispose, disposed);
+				x = next;
+			}
+		}
+	}
+
+	template <class Dispose>
+	static Sub UnionOf(Sub a, Sub b, Dispose& dispose, std::atomic<size_t>& disposed, int budget)
+	{
+		if(a.root == NULL)
+			return b;
+		if(b.root == NULL)
+			return a;
+		RB_Node* k = a.root;
+		int cbh = ChildHeight(k, a.bh);
+		Sub aLeft = { k->left, cbh };
+		Sub aRight = { k->right, cbh };
+		Sub bLeft;
+		Sub bRight;
+		RB_Node* match;
+		SplitAt(b, Traits::KeyOf(k), bLeft, match, bRight);
+
+		Sub left;
+		Sub right;
+		Fork(budget > 0 && a.bh + b.bh >= 2 * PARALLEL_BH,
+			[&]() { left = UnionOf(aLeft, bLeft, dispose, disposed, budget - 1); },
+			[&]() { right = UnionOf(aRight, bRight, dispose, disposed, budget - 1); });
+		if(match != NULL)
+			Drop(match, dispose, disposed);
+		return Link(left, k, right);
+	}
+
+	template <class Dispose>
+	static Sub IntersectionOf(Sub a, Sub b, Dispose& dispose, std::atomic<size_t>& disposed, int budget)
+	{
+		Sub empty = { NULL, 0 };
+		if(a.root == NULL || b.root == NULL)
+		{
+			DropAll(a.root, dispose, disposed);
+			DropAll(b.root, dispose, disposed);
+			return empty;
+		}
+		RB_Node* k = a.root;
+		int cbh = ChildHeight(k, a.bh);
+		Sub aLeft = { k->left, cbh };
+		Sub aRight = { k->right, cbh };
+		Sub bLeft;
+		Sub bRight;
+		RB_Node* match;
+		SplitAt(b, Traits::KeyOf(k), bLeft, match, bRight);
+
+		Sub left;
+		Sub right;
+		Fork(budget > 0 && a.bh + b.bh >= 2 * PARALLEL_BH,
+			[&]() { left = IntersectionOf(aLeft, bLeft, dispose, disposed, budget - 1); },
+			[&]() { right = IntersectionOf(aRight, bRight, dispose, disposed, budget - 1); });
+		if(match != NULL)
+		{
+			Drop(match, dispose, disposed);
+			return Link(left, k, right);
+		}
+		Drop(k, dispose, disposed);
+		return Concat(left, right);
+	}
+
+	template <class Dispose>
+	static Sub DifferenceOf(Sub a, Sub b, Dispose& dispose, std::atomic<size_t>& disposed, int budget)
+	{
+		if(a.root == NULL)
+		{
+			DropAll(b.root, dispose, disposed);
+			return a;
+		}
+		if(b.root == NULL)
+			return a;
+		RB_Node* k = b.root;
+		int cbh = ChildHeight(k, b.bh);
+		Sub bLeft = { k->left, cbh };
+		Sub bRight = { k->right, cbh };
+		Sub aLeft;
+		Sub aRight;
+		RB_Node* match;
+		SplitAt(a, Traits::KeyOf(k), aLeft, match, aRight);
+
+		Sub left;
+		Sub right;
+		Fork(budget > 0 && a.bh + b.bh >= 2 * PARALLEL_BH,
+			[&]() { left = DifferenceOf(aLeft, bLeft, dispose, disposed, budget - 1); },
+			[&]() { right = DifferenceOf(aRight, bRight, dispose, disposed, budget - 1); });
+		Drop(k, dispose, disposed);
+		if(match != NULL)
+			Drop(match, dispose, disposed);
+		return Concat(left, right);
+	}
+
+	//Perfectly balanced tree over nodes[lo, hi), nodes at depth fullLevels are the red ones
+	static RB_Node* Build(T** nodes, size_t lo, size_t hi, int depth, int fullLevels, int budget)
+	{
+		if(lo == hi)
+			return NULL;
+		size_t mid = lo + (hi - lo) / 2;
+		RB_Node* x = nodes[mid];
+		RB_Node* l;
+		RB_Node* r;
+		Fork(budget > 0 && hi - lo >= ((size_t) 2 << PARALLEL_BH),
+			[&]() { l = Build(nodes, lo, mid, depth + 1, fullLevels, budget - 1); },
+			[&]() { r = Build(nodes, mid + 1, hi, depth + 1, fullLevels, budget - 1); });
+		x->SetColor(depth >= fullLevels ? RED : BLACK);
+		Attach(x, l, r);
+		return x;
+	}
+};
+
+//left becomes left, k, right in that order and right is emptied.  Every key in
+//left must be less than k's and every key in right greater.
+template <class T, class Traits>
+void RB_Join(RB_Tree<T, Traits>& left, T* k, RB_Tree<T, Traits>& right)
+{
+	RB_JoinOps<T, Traits>::Join(left, k, right);
+}
+
+//Moves every key greater than key from tree into the empty tree right and
+//unlinks the node equal to key, which is returned (NULL if there is none)
+template <class T, class Traits>
+T* RB_Split(RB_Tree<T, Traits>& tree, const typename Traits::Key& key, RB_Tree<T, Traits>& right)
+{
+	return RB_JoinOps<T, Traits>::Split(tree, key, right);
+}
+
+//a becomes a union b, b is emptied.  Where both hold a key a's node is kept.
+template <class T, class Traits, class Dispose>
+void RB_Union(RB_Tree<T, Traits>& a, RB_Tree<T, Traits>& b, Dispose dispose)
+{
+	RB_JoinOps<T, Traits>::Union(a, b, dispose);
+}
+
+//a keeps only keys also in b, b is emptied
+template <class T, class Traits, class Dispose>
+void RB_Intersection(RB_Tree<T, Traits>& a, RB_Tree<T, Traits>& b, Dispose dispose)
+{
+	RB_JoinOps<T, Traits>::Intersection(a, b, dispose);
+}
+
+//a loses every key that is in b, b is emptied
+template <class T, class Traits, class Dispose>
+void RB_Difference(RB_Tree<T, Traits>& a, RB_Tree<T, Traits>& b, Dispose dispose)
+{
+	RB_JoinOps<T, Traits>::Difference(a, b, dispose);
+}
+
+//Fills the empty tree with nodes[0, n), which must be in strictly increasing key order
+template <class T, class Traits>
+void RB_BuildSorted(RB_Tree<T, Traits>& tree, T** nodes, size_t n)
+{
+	RB_JoinOps<T, Traits>::BuildSorted(tree, nodes, n);
+}
+
+#endif /* RB_JOIN_H_ */
@@ -5,22 +5,11 @@
  *      Author: kurtisthompson
  */
 
-#include <iostream.h>
 #include "RB_Node.h"
 
 RB_Node::RB_Node()
 {
 	right = NULL;
 	left = NULL;
-	p = NULL;
-	color = RED;
-	key = NULL;
+	parentAndColor = (uintptr_t) RED;
 }
-
-RB_Node::~RB_Node()
-{
-	delete right;
-	delete left;
-	delete p;
-}
-
@@ -8,35 +8,46 @@
 #ifndef RB_NODE_H_
 #define RB_NODE_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 using namespace std;
 
-//Nodes are either RED or BLACK
+//Nodes are either RED or BLACK, the values are the bit kept in the parent pointer
 enum COLOR{ RED, BLACK};
 
-RB_Node* sentinal;
-
+/*
+ * The links a red-black tree keeps in every element.  Anything that should live
+ * in an RB_Tree derives from RB_Node and carries its own key, so linking it in
+ * allocates nothing.  The tree never deletes nodes, whoever made them does.
+ *
+ * Nodes are at least pointer aligned, so the low bit of the parent pointer is
+ * always zero and holds the color instead.  That keeps the links at three words.
+ */
 class RB_Node{
 
 public:
 	//Constructor
 	RB_Node();
-	//Destructor
-	~RB_Node();
 	//Right Child
 	RB_Node* right;
 	//Left Child
 	RB_Node* left;
-	//Parent Pointer
-	RB_Node* p;
-	//Simple integer key to correspond to the text
-	int key;
-	//Node color value
-	COLOR color;
 
+	RB_Node* Parent() const { return reinterpret_cast<RB_Node*>(parentAndColor & ~(uintptr_t) 1); }
+	void SetParent(RB_Node* parent) { parentAndColor = reinterpret_cast<uintptr_t>(parent) | (parentAndColor & 1); }
+	COLOR Color() const { return (COLOR) (parentAndColor & 1); }
+	void SetColor(COLOR c) { parentAndColor = (parentAndColor & ~(uintptr_t) 1) | (uintptr_t) c; }
 
+private:
+	//Parent Pointer, the low bit is the node color
+	uintptr_t parentAndColor;
 };
 
-
-
+//NULL leaves count as black
+inline bool RB_IsRed(const RB_Node* n)
+{
+	return n != NULL && n->Color() == RED;
+}
 
 #endif /* RB_NODE_H_ */
@@ -0,0 +1,123 @@
+/*
+ * RB_OrderTree.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Order statistic tree (CLRS section 14.1) on top of RB_Tree.
+ *
+ *  Every node also records the size of its subtree.  RB_Tree keeps the sizes
+ *  right through its rotations, inserts and deletes by calling the traits'
+ *  Update, so ranks, selects and range counts walk one root to leaf path.
+ *  Equal keys are allowed, which is what a histogram of samples needs.
+ */
+
+#ifndef RB_ORDERTREE_H_
+#define RB_ORDERTREE_H_
+
+#include "RB_Tree.h"
+
+//Hook for nodes of an RB_OrderTree
+class RB_SizeNode : public RB_Node
+{
+
+public:
+	RB_SizeNode() : size(1) {}
+
+	//Nodes in the subtree rooted here, this one included
+	size_t size;
+};
+
+inline size_t RB_SubtreeSize(const RB_Node* n)
+{
+	return n == NULL ? 0 : static_cast<const RB_SizeNode*>(n)->size;
+}
+
+template <class T, class K = int, class Compare = std::less<K> >
+struct RB_SizeTraits : public RB_KeyTraits<T, K, Compare>
+{
+	static const bool AUGMENTED = true;
+
+	static void Update(RB_Node* n)
+	{
+		static_cast<RB_SizeNode*>(n)->size = 1 + RB_SubtreeSize(n->left) + RB_SubtreeSize(n->right);
+	}
+};
+
+/*
+ * Intrusive like RB_Tree, over nodes of type T that derive from RB_SizeNode
+ * and have a member named key.
+ */
+template <class T, class K = int, class Compare = std::less<K> >
+class RB_OrderTree : public RB_Tree<T, RB_SizeTraits<T, K, Compare> >
+{
+
+public:
+	typedef K Key;
+
+	//Number of keys less than key
+	size_t RB_Rank(const Key& key)
+	{
+		RB_Node* x = this->RB_GetRoot();
+		size_t rank = 0;
+		while(x != NULL)
+		{
+			if(Less(KeyOf(x), key))
+			{
+				rank += RB_SubtreeSize(x->left) + 1;
+				x = x->right;
+			}
+			else
+				x = x->left;
+		}
+		return rank;
+	}
+
+	//The node with index i (0 based) in key order, NULL if there are not that many
+	T* RB_Select(size_t i)
+	{
+		RB_Node* x = this->RB_GetRoot();
+		while(x != NULL)
+		{
+			size_t left = RB_SubtreeSize(x->left);
+			if(i < left)
+				x = x->left;
+			else if(i == left)
+				return static_cast<T*>(x);
+			else
+			{
+				i -= left + 1;
+				x = x->right;
+			}
+		}
+		return NULL;
+	}
+
+	//Index of node in key order, counting up the parent pointers
+	size_t RB_IndexOf(const T* node)
+	{
+		const RB_Node* x = node;
+		size_t index = RB_SubtreeSize(x->left);
+		for(const RB_Node* p = x->Parent(); p != NULL; x = p, p = p->Parent())
+		{
+			if(x == p->right)
+				index += RB_SubtreeSize(p->left) + 1;
+		}
+		return index;
+	}
+
+	//Number of keys in [lo, hi)
+	size_t RB_CountRange(const Key& lo, const Key& hi)
+	{
+		if(!Less(lo, hi))
+			return 0;
+		return RB_Rank(hi) - RB_Rank(lo);
+	}
+
+private:
+	typedef RB_SizeTraits<T, K, Compare> Traits;
+
+	static const Key& KeyOf(const RB_Node* n) { return Traits::KeyOf(n); }
+	static bool Less(const Key& a, const Key& b) { return Traits::Less(a, b); }
+};
+
+#endif /* RB_ORDERTREE_H_ */
@@ -0,0 +1,596 @@
+/*
+ * RB_PersistentTree.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Persistent red-black set: every write makes a new version and old ones stay readable.
+ *
+ *  Published nodes are never changed.  Insert and delete copy the nodes on the
+ *  path they walk, plus any sibling the fixup has to recolor or rotate, and the
+ *  copies share every other subtree with the old version.  That is O(log n)
+ *  new nodes per write.  The new root is then published with one atomic store.
+ *
+ *  Readers load the root and walk it without locks or retries, so a lookup is
+ *  wait-free and always sees one whole version.  RB_Snapshot keeps a version
+ *  for as long as the caller likes.  Writers are serialized by a mutex and
+ *  never wait for readers.
+ *
+ *  Nodes a write replaces are retired through the EpochManager and freed once
+ *  every reader that was active at the time has left, so a snapshot holds the
+ *  calling thread in its epoch until it is destroyed.  Nodes carry subtree
+ *  sizes, so every version also answers size, rank and select queries.
+ */
+
+#ifndef RB_PERSISTENTTREE_H_
+#define RB_PERSISTENTTREE_H_
+
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include "RB_Node.h"
+#include "../Common/EpochManager.h"
+
+template <class Key, class Compare = std::less<Key> >
+class RB_PersistentTree
+{
+
+private:
+	struct Node
+	{
+		Key key;
+		Node* left;
+		Node* right;
+		size_t size;
+		COLOR color;
+
+		Node(const Key& k, Node* l, Node* r, size_t s, COLOR c) : key(k), left(l), right(r), size(s), color(c) {}
+
+		static void Destroy(void* p)
+		{
+			delete static_cast<Node*>(p);
+		}
+	};
+
+	//Enough for any red-black tree that fits in memory
+	static const int MAX_HEIGHT = 128;
+
+	std::atomic<Node*> root;
+	std::mutex writeLock;
+	Compare less;
+
+	RB_PersistentTree(const RB_PersistentTree&);
+	RB_PersistentTree& operator=(const RB_PersistentTree&);
+
+	static bool IsRed(const Node* n) { return n != NULL && n->color == RED; }
+	static size_t Size(const Node* n) { return n == NULL ? 0 : n->size; }
+	static void Resize(Node* n) { n->size = 1 + Size(n->left) + Size(n->right); }
+
+	/*
+	 * Collects the nodes one write replaces.  Nothing in the new version points
+	 * at them, so they are retired once the new root is out.
+	 */
+	struct Write
+	{
+		Node* replaced[3 * MAX_HEIGHT];
+		int count;
+
+		Write() : count(0) {}
+
+		//A private copy of n that the write may change freely
+		Node* Copy(Node* n)
+		{
+			replaced[count++] = n;
+			return new Node(n->key, n->left, n->right, n->size, n->color);
+		}
+
+		void Retire()
+		{
+			for(int i = 0; i < count; i++)
+				EpochManager::instance().retire(replaced[i], &Node::Destroy);
+		}
+	};
+
+	//*link holds x, which becomes the left child of its right child
+	static void Left_Rotate(Node** link)
+	{
+		Node* x = *link;
+		Node* y = x->right;
+		x->right = y->left;
+		y->left = x;
+		*link = y;
+		Resize(x);
+		Resize(y);
+	}
+
+	static void Right_Rotate(Node** link)
+	{
+		Node* x = *link;
+		Node* y = x->left;
+		x->left = y->right;
+		y->right = x;
+		*link = y;
+		Resize(x);
+		Resize(y);
+	}
+
+	static Node** ChildLink(Node* parent, Node* child)
+	{
+		return parent->left == child ? &parent->left : &parent->right;
+	}
+
+	/*
+	 * CLRS insert fixup on a copied path.  path[0..top] are copies, path[top]
+	 * is the new red node and links[i] is the slot that holds path[i].
+	 */
+	static void RB_Insert_Fixup(Node** path, Node*** links, int top, Write& w)
+	{
+		int i = top;
+		while(i >= 2 && IsRed(path[i - 1]))
+		{
+			Node* parent = path[i - 1];
+			Node* grandparent = path[i - 2];
+			if(parent == grandparent->left)
+			{
+				if(IsRed(grandparent->right))
+				{
+					//Recoloring the uncle changes it, so it gets copied too
+					grandparent->right = w.Copy(grandparent->right);
+					grandparent->right->color = BLACK;
+					parent->color = BLACK;
+					grandparent->color = RED;
+					i -= 2;
+				}
+				else
+				{
+					if(path[i] == parent->right)
+					{
+						Left_Rotate(links[i - 1]);
+						parent = *links[i - 1];
+					}
+					parent->color = BLACK;
+					grandparent->color = RED;
+					Right_Rotate(links[i - 2]);
+					break;
+				}
+			}
+			else
+			{
+				if(IsRed(grandparent->left))
+				{
+					grandparent->left = w.Copy(grandparent->left);
+					grandparent->left->color = BLACK;
+					parent->color = BLACK;
+					grandparent->color = RED;
+					i -= 2;
+				}
+				else
+				{
+					if(path[i] == parent->left)
+					{
+						Right_Rotate(links[i - 1]);
+						parent = *links[i - 1];
+					}
+					parent->color = BLACK;
+					grandparent->color = RED;
+					Left_Rotate(links[i - 2]);
+					break;
+				}
+			}
+		}
+		(*links[0])->color = BLACK;
+	}
+
+	/*
+	 * CLRS delete fixup on a copied path.  The subtree in the slot *xLink under
+	 * path[j] is one black short.  Siblings and their children are copied
+	 * before they are recolored or rotated.
+	 */
+	static void RB_Delete_Fixup(Node** path, Node*** links, int j, Node** xLink, Write& w)
+	{
+		while(j >= 0 && !IsRed(*xLink))
+		{
+			Node* parent = path[j];
+			//After a case 1 rotation parent hangs from the sibling, not from links[j]
+			Node** parentLink = links[j];
+			if(xLink == &parent->left)
+			{
+				parent->right = w.Copy(parent->right);
+				Node* s = parent->right;
+				if(IsRed(s))
+				{
+					s->color = BLACK;
+					parent->color = RED;
+					Left_Rotate(parentLink);
+					parentLink = &s->left;
+					parent->right = w.Copy(parent->right);
+					s = parent->right;
+				}
+				if(!IsRed(s->left) && !IsRed(s->right))
+				{
+					s->color = RED;
+					if(IsRed(parent) || parentLink != links[j])
+					{
+						//A red parent absorbs the extra black
+						parent->color = BLACK;
+						return;
+					}
+					j--;
+					xLink = links[j + 1];
+				}
+				else
+				{
+					if(!IsRed(s->right))
+					{
+						s->left = w.Copy(s->left);
+						s->left->color = BLACK;
+						s->color = RED;
+						Right_Rotate(&parent->right);
+						s = parent->right;
+					}
+					else
+						s->right = w.Copy(s->right);
+					s->color = parent->color;
+					parent->color = BLACK;
+					s->right->color = BLACK;
+					Left_Rotate(parentLink);
+					return;
+				}
+			}
+			else
+			{
+				parent->left = w.Copy(parent->left);
+				Node* s = parent->left;
+				if(IsRed(s))
+				{
+					s->color = BLACK;
+					parent->color = RED;
+					Right_Rotate(parentLink);
+					parentLink = &s->right;
+					parent->left = w.Copy(parent->left);
+					s = parent->left;
+				}
+				if(!IsRed(s->left) && !IsRed(s->right))
+				{
+					s->color = RED;
+					if(IsRed(parent) || parentLink != links[j])
+					{
+						parent->color = BLACK;
+						return;
+					}
+					j--;
+					xLink = links[j + 1];
+				}
+				else
+				{
+					if(!IsRed(s->left))
+					{
+						s->right = w.Copy(s->right);
+						s->right->color = BLACK;
+						s->color = RED;
+						Left_Rotate(&parent->left);
+						s = parent->left;
+					}
+					else
+						s->left = w.Copy(s->left);
+					s->color = parent->color;
+					parent->color = BLACK;
+					s->left->color = BLACK;
+					Right_Rotate(parentLink);
+					return;
+				}
+			}
+		}
+		if(*xLink != NULL && IsRed(*xLink))
+		{
+			//x is shared with the old version, so it is copied before it turns black
+			*xLink = w.Copy(*xLink);
+			(*xLink)->color = BLACK;
+		}
+	}
+
+	//Frees every node reachable from x, for the destructor only
+	static void DestroyAll(Node* x)
+	{
+		while(x != NULL)
+		{
+			if(x->left != NULL)
+			{
+				Node* l = x->left;
+				x->left = l->right;
+				l->right = x;
+				x = l;
+			}
+			else
+			{
+				Node* next = x->right;
+				delete x;
+				x = next;
+			}
+		}
+	}
+
+public:
+	/*
+	 * One version of the tree, unchanged by later writes.  While it exists the
+	 * calling thread stays in its epoch, so it must be destroyed on the thread
+	 * that took it, and a thread holding one for a long time delays freeing
+	 * memory for every writer.
+	 */
+	class Snapshot
+	{
+
+	private:
+		friend class RB_PersistentTree;
+		const Node* top;
+		Compare less;
+		bool guarded;
+
+		explicit Snapshot(const std::atomic<Node*>& root) : guarded(true)
+		{
+			EpochManager::instance().enter();
+			top = root.load(std::memory_order_acquire);
+		}
+
+		Snapshot(const Snapshot&);
+		Snapshot& operator=(const Snapshot&);
+
+	public:
+		Snapshot(Snapshot&& other) : top(other.top), guarded(other.guarded)
+		{
+			other.guarded = false;
+		}
+
+		~Snapshot()
+		{
+			if(guarded)
+				EpochManager::instance().exit();
+		}
+
+		size_t RB_Size() const
+		{
+			return Size(top);
+		}
+
+		bool RB_Contains(const Key& key) const
+		{
+			const Node* x = top;
+			while(x != NULL)
+			{
+				if(less(key, x->key))
+					x = x->left;
+				else if(less(x->key, key))
+					x = x->right;
+				else
+					return true;
+			}
+			return false;
+		}
+
+		//Smallest key not less than key, NULL if there is none
+		const Key* RB_LowerBound(const Key& key) const
+		{
+			const Node* x = top;
+			const Node* result = NULL;
+			while(x != NULL)
+			{
+				if(less(x->key, key))
+					x = x->right;
+				else
+				{
+					result = x;
+					x = x->left;
+				}
+			}
+			return result == NULL ? NULL : &result->key;
+		}
+
+		//Number of keys less than key
+		size_t RB_Rank(const Key& key) const
+		{
+			const Node* x = top;
+			size_t rank = 0;
+			while(x != NULL)
+			{
+				if(less(x->key, key))
+				{
+					rank += Size(x->left) + 1;
+					x = x->right;
+				}
+				else
+					x = x->left;
+			}
+			return rank;
+		}
+
+		//Key with index i (0 based) in order, NULL if there are not that many
+		const Key* RB_Select(size_t i) const
+		{
+			const Node* x = top;
+			while(x != NULL)
+			{
+				if(i < Size(x->left))
+					x = x->left;
+				else if(i == Size(x->left))
+					return &x->key;
+				else
+				{
+					i -= Size(x->left) + 1;
+					x = x->right;
+				}
+			}
+			return NULL;
+		}
+
+		//Calls visit(key) for every key in [lo, hi) in order
+		template <class Visitor>
+		void RB_Range(const Key& lo, const Key& hi, Visitor visit) const
+		{
+			//Nodes are immutable and have no parent links, so the way back up is a stack
+			const Node* stack[MAX_HEIGHT];
+			int depth = 0;
+			const Node* x = top;
+			while(x != NULL || depth > 0)
+			{
+				while(x != NULL)
+				{
+					if(less(x->key, lo))
+						x = x->right;
+					else
+					{
+						stack[depth++] = x;
+						x = x->left;
+					}
+				}
+				if(depth == 0)
+					return;
+				x = stack[--depth];
+				if(!less(x->key, hi))
+					return;
+				visit(x->key);
+				x = x->right;
+			}
+		}
+	};
+
+	RB_PersistentTree() : root(NULL)
+	{
+	}
+
+	//Must not run while readers, writers or snapshots are still around
+	~RB_PersistentTree()
+	{
+		DestroyAll(root.load());
+	}
+
+	//The current version
+	Snapshot RB_Snapshot() const
+	{
+		return Snapshot(root);
+	}
+
+	size_t RB_Size() const
+	{
+		return RB_Snapshot().RB_Size();
+	}
+
+	bool RB_Contains(const Key& key) const
+	{
+		return RB_Snapshot().RB_Contains(key);
+	}
+
+	//Returns false if key was already present
+	bool RB_Insert(const Key& key)
+	{
+		std::lock_guard<std::mutex> held(writeLock);
+		EpochGuard guard;
+		Node* oldRoot = root.load(std::memory_order_relaxed);
+
+		//Find the leaf first so a duplicate copies nothing
+		Node* x = oldRoot;
+		while(x != NULL)
+		{
+			if(less(key, x->key))
+				x = x->left;
+			else if(less(x->key, key))
+				x = x->right;
+			else
+				return false;
+		}
+
+		Write w;
+		Node* path[MAX_HEIGHT];
+		Node** links[MAX_HEIGHT];
+		Node* newRoot = oldRoot;
+		Node** link = &newRoot;
+		int top = 0;
+		while(*link != NULL)
+		{
+			Node* copy = w.Copy(*link);
+			copy->size++;
+			*link = copy;
+			path[top] = copy;
+			links[top] = link;
+			top++;
+			link = less(key, copy->key) ? &copy->left : &copy->right;
+		}
+		*link = new Node(key, NULL, NULL, 1, RED);
+		path[top] = *link;
+		links[top] = link;
+
+		RB_Insert_Fixup(path, links, top, w);
+		root.store(newRoot, std::memory_order_release);
+		w.Retire();
+		return true;
+	}
+
+	//Returns false if key was not present
+	bool RB_Delete(const Key& key)
+	{
+		std::lock_guard<std::mutex> held(writeLock);
+		EpochGuard guard;
+		Node* oldRoot = root.load(std::memory_order_relaxed);
+
+		Node* x = oldRoot;
+		while(x != NULL && (less(key, x->key) || less(x->key, key)))
+			x = less(key, x->key) ? x->left : x->right;
+		if(x == NULL)
+			return false;
+
+		//Copy the path down to key, and on to its successor if it has two children
+		Write w;
+		Node* path[MAX_HEIGHT];
+		Node** links[MAX_HEIGHT];
+		Node* newRoot = oldRoot;
+		Node** link = &newRoot;
+		int top = -1;
+		Node* target = NULL;
+		for(;;)
+		{
+			Node* copy = w.Copy(*link);
+			copy->size--;
+			*link = copy;
+			path[++top] = copy;
+			links[top] = link;
+			if(target == NULL && !less(key, copy->key) && !less(copy->key, key))
+			{
+				target = copy;
+				if(copy->left == NULL || copy->right == NULL)
+					break;
+				link = &copy->right;
+			}
+			else if(target != NULL)
+			{
+				if(copy->left == NULL)
+					break;
+				link = &copy->left;
+			}
+			else
+				link = less(key, copy->key) ? &copy->left : &copy->right;
+		}
+
+		//path[top] has at most one child and is the node that actually goes away
+		Node* gone = path[top];
+		if(gone != target)
+			target->key = gone->key;
+		Node* child = gone->left != NULL ? gone->left : gone->right;
+		*links[top] = child;
+		if(gone->color == BLACK)
+		{
+			//The copy of gone is unreachable, leave it out of the path
+			Node** xLink = links[top];
+			RB_Delete_Fixup(path, links, top - 1, xLink, w);
+		}
+		delete gone;
+
+		if(newRoot != NULL && newRoot->color == RED)
+		{
+			//newRoot is always a copy here, so it can be changed in place
+			newRoot->color = BLACK;
+		}
+		root.store(newRoot, std::memory_order_release);
+		w.Retire();
+		return true;
+	}
+};
+
+#endif /* RB_PERSISTENTTREE_H_ */
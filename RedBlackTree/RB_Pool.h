@@ -0,0 +1,140 @@
+/*
+ * RB_Pool.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Slab allocator for fixed size tree nodes.
+ *
+ *  Slots are carved out of large slabs, the first one 4KB and each one after
+ *  that twice the size up to 1MB.  Released slots go on a free list and are
+ *  handed out again before any new slab memory, so a tree that churns at a
+ *  steady size stops calling malloc altogether.  RB_Clear throws every slot
+ *  away at once but keeps the slabs for reuse.
+ */
+
+#ifndef RB_POOL_H_
+#define RB_POOL_H_
+
+#include <stdlib.h>
+#include <new>
+#include <vector>
+
+class RB_Pool
+{
+
+public:
+	//Every slot is objectSize bytes, aligned to alignment (a power of two)
+	RB_Pool(size_t objectSize, size_t alignment)
+	{
+		if(alignment < sizeof(void*))
+			alignment = sizeof(void*);
+		if(objectSize < sizeof(FreeSlot))
+			objectSize = sizeof(FreeSlot);
+		slotSize = (objectSize + alignment - 1) & ~(alignment - 1);
+		slotAlignment = alignment;
+		current = 0;
+		next = NULL;
+		end = NULL;
+		freeList = NULL;
+		reserved = 0;
+	}
+
+	~RB_Pool()
+	{
+		for(size_t i = 0; i < slabs.size(); i++)
+			free(slabs[i].memory);
+	}
+
+	void* RB_Allocate()
+	{
+		if(freeList != NULL)
+		{
+			FreeSlot* slot = freeList;
+			freeList = slot->next;
+			return slot;
+		}
+		if(next == NULL || (size_t) (end - next) < slotSize)
+			NextSlab();
+		void* p = next;
+		next += slotSize;
+		return p;
+	}
+
+	//p must have come from RB_Allocate on this pool
+	void RB_Release(void* p)
+	{
+		FreeSlot* slot = static_cast<FreeSlot*>(p);
+		slot->next = freeList;
+		freeList = slot;
+	}
+
+	//Makes every slot free again without returning memory to the system
+	void RB_Clear()
+	{
+		freeList = NULL;
+		current = 0;
+		next = NULL;
+		end = NULL;
+	}
+
+	size_t RB_BytesReserved() const
+	{
+		return reserved;
+	}
+
+private:
+	static const size_t FIRST_SLAB = 4096;
+	static const size_t MAX_SLAB = 1 << 20;
+
+	struct FreeSlot
+	{
+		FreeSlot* next;
+	};
+
+	struct Slab
+	{
+		char* memory;
+		size_t size;
+	};
+
+	size_t slotSize;
+	size_t slotAlignment;
+	std::vector<Slab> slabs;
+	//Index of the slab after the one being carved up
+	size_t current;
+	char* next;
+	char* end;
+	FreeSlot* freeList;
+	size_t reserved;
+
+	RB_Pool(const RB_Pool&);
+	RB_Pool& operator=(const RB_Pool&);
+
+	//Moves on to the next slab, reusing one kept by RB_Clear if there is one
+	void NextSlab()
+	{
+		if(current == slabs.size())
+		{
+			size_t size = FIRST_SLAB;
+			if(!slabs.empty())
+				size = slabs.back().size * 2;
+			if(size > MAX_SLAB)
+				size = MAX_SLAB;
+			if(size < slotSize + slotAlignment)
+				size = slotSize + slotAlignment;
+			Slab slab;
+			slab.memory = static_cast<char*>(malloc(size));
+			if(slab.memory == NULL)
+				throw std::bad_alloc();
+			slab.size = size;
+			slabs.push_back(slab);
+			reserved += size;
+		}
+		Slab& slab = slabs[current++];
+		size_t misalignment = (size_t) slab.memory & (slotAlignment - 1);
+		next = slab.memory + (misalignment == 0 ? 0 : slotAlignment - misalignment);
+		end = slab.memory + slab.size;
+	}
+};
+
+#endif /* RB_POOL_H_ */
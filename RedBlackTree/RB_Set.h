@@ -0,0 +1,149 @@
+/*
+ * RB_Set.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Owning ordered set on top of the intrusive RB_Tree.
+ *
+ *  Keys are copied into nodes taken from an RB_Pool, so inserts and deletes
+ *  recycle node memory instead of going to malloc, and RB_Clear drops the whole
+ *  set without visiting a node when Key needs no destructor.
+ */
+
+#ifndef RB_SET_H_
+#define RB_SET_H_
+
+#include <new>
+#include <functional>
+#include <type_traits>
+#include "RB_Tree.h"
+#include "RB_Pool.h"
+
+template <class Key, class Compare = std::less<Key> >
+class RB_Set
+{
+
+private:
+	struct Entry : public RB_Node
+	{
+		Key key;
+
+		explicit Entry(const Key& k) : key(k) {}
+	};
+
+	typedef RB_Tree<Entry, RB_KeyTraits<Entry, Key, Compare> > Tree;
+
+	Tree tree;
+	RB_Pool pool;
+
+	RB_Set(const RB_Set&);
+	RB_Set& operator=(const RB_Set&);
+
+	void Destroy(Entry* e)
+	{
+		e->~Entry();
+		pool.RB_Release(e);
+	}
+
+	//Runs every destructor without recursion by rotating left children up
+	void DestroyAll()
+	{
+		RB_Node* x = tree.RB_GetRoot();
+		while(x != NULL)
+		{
+			if(x->left != NULL)
+			{
+				RB_Node* l = x->left;
+				x->left = l->right;
+				l->right = x;
+				x = l;
+			}
+			else
+			{
+				RB_Node* next = x->right;
+				static_cast<Entry*>(x)->~Entry();
+				x = next;
+			}
+		}
+	}
+
+public:
+	RB_Set() : pool(sizeof(Entry), alignof(Entry))
+	{
+	}
+
+	~RB_Set()
+	{
+		if(!std::is_trivially_destructible<Key>::value)
+			DestroyAll();
+	}
+
+	size_t RB_Size() const
+	{
+		return tree.RB_Size();
+	}
+
+	bool RB_Empty() const
+	{
+		return tree.RB_Empty();
+	}
+
+	//Returns false if key was already present
+	bool RB_Insert(const Key& key)
+	{
+		//Looked up first so a duplicate costs no copy of the key
+		if(tree.RB_Find(key) != NULL)
+			return false;
+		void* slot = pool.RB_Allocate();
+		Entry* e;
+		try
+		{
+			e = new (slot) Entry(key);
+		}
+		catch(...)
+		{
+			pool.RB_Release(slot);
+			throw;
+		}
+		tree.RB_Insert(e);
+		return true;
+	}
+
+	//Returns false if key was not present
+	bool RB_Delete(const Key& key)
+	{
+		Entry* e = tree.RB_Find(key);
+		if(e == NULL)
+			return false;
+		tree.RB_Delete(e);
+		Destroy(e);
+		return true;
+	}
+
+	bool RB_Contains(const Key& key) const
+	{
+		return tree.RB_Find(key) != NULL;
+	}
+
+	//Smallest key not less than key, NULL if there is none
+	const Key* RB_LowerBound(const Key& key) const
+	{
+		Entry* e = tree.RB_LowerBound(key);
+		return e == NULL ? NULL : &e->key;
+	}
+
+	void RB_Clear()
+	{
+		if(!std::is_trivially_destructible<Key>::value)
+			DestroyAll();
+		tree.RB_Clear();
+		pool.RB_Clear();
+	}
+
+	size_t RB_BytesReserved() const
+	{
+		return pool.RB_BytesReserved();
+	}
+};
+
+#endif /* RB_SET_H_ */
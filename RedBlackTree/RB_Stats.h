@@ -0,0 +1,117 @@
+/*
+ * RB_Stats.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Hot path counters for RB_Tree, compiled in only with -DRB_STATS.
+ *
+ *  With RB_STATS defined, every RB_Tree counts its inserts, deletes, fixup
+ *  loop iterations and rotations, and the depth each insert links its node
+ *  at, into per-thread counters (see ThreadCounters.h).  RB_StatsSnapshot
+ *  adds them up over every thread and every tree.  Without RB_STATS the
+ *  counting compiles to nothing and the snapshot is all zeros.  The macro has
+ *  to be the same for the whole program.
+ *
+ *  Rotations or fixup iterations per insert well above 1, or depths past
+ *  2 log2(n), mean the tree is doing more work than a red-black tree should.
+ */
+
+#ifndef RB_STATS_H_
+#define RB_STATS_H_
+
+#include <stdint.h>
+#include "../Common/ThreadCounters.h"
+
+#ifdef RB_STATS
+#define RB_STATS_ONLY(...) __VA_ARGS__
+#else
+#define RB_STATS_ONLY(...)
+#endif
+
+//Insert depths from 0 up, the last bucket also counts everything deeper
+static const int RB_STATS_DEPTHS = 64;
+
+enum RB_Counter
+{
+	RB_INSERTS,
+	RB_DELETES,
+	RB_INSERT_FIXUP_LOOPS,
+	RB_INSERT_ROTATIONS,
+	RB_DELETE_FIXUP_LOOPS,
+	RB_DELETE_ROTATIONS,
+	RB_INSERT_DEPTH,
+	RB_COUNTERS = RB_INSERT_DEPTH + RB_STATS_DEPTHS
+};
+
+struct RB_StatsTag;
+typedef ThreadCounters<RB_StatsTag, RB_COUNTERS> RB_StatsCounters;
+
+inline void RB_Count(RB_Counter counter, uint64_t n = 1)
+{
+	RB_StatsCounters::add(counter, n);
+}
+
+inline void RB_CountInsertDepth(unsigned depth)
+{
+	RB_StatsCounters::add(RB_INSERT_DEPTH + (depth < (unsigned) RB_STATS_DEPTHS ? depth : RB_STATS_DEPTHS - 1));
+}
+
+struct RB_Stats
+{
+	//False when the program was built without RB_STATS
+	bool enabled;
+	uint64_t inserts;
+	uint64_t deletes;
+	uint64_t insertFixupLoops;
+	uint64_t insertRotations;
+	uint64_t deleteFixupLoops;
+	uint64_t deleteRotations;
+	//insertDepth[d] is the number of inserts that linked their node d levels below the root
+	uint64_t insertDepth[RB_STATS_DEPTHS];
+
+	double RotationsPerInsert() const
+	{
+		return inserts == 0 ? 0 : (double) insertRotations / inserts;
+	}
+
+	double RotationsPerDelete() const
+	{
+		return deletes == 0 ? 0 : (double) deleteRotations / deletes;
+	}
+
+	double MeanInsertDepth() const
+	{
+		uint64_t total = 0;
+		uint64_t weighted = 0;
+		for(int d = 0; d < RB_STATS_DEPTHS; d++)
+		{
+			total += insertDepth[d];
+			weighted += insertDepth[d] * d;
+		}
+		return total == 0 ? 0 : (double) weighted / total;
+	}
+};
+
+//The counts so far, summed over every thread
+inline RB_Stats RB_StatsSnapshot()
+{
+	uint64_t values[RB_COUNTERS] = {};
+	RB_Stats stats;
+#ifdef RB_STATS
+	RB_StatsCounters::snapshot(values);
+	stats.enabled = true;
+#else
+	stats.enabled = false;
+#endif
+	stats.inserts = values[RB_INSERTS];
+	stats.deletes = values[RB_DELETES];
+	stats.insertFixupLoops = values[RB_INSERT_FIXUP_LOOPS];
+	stats.insertRotations = values[RB_INSERT_ROTATIONS];
+	stats.deleteFixupLoops = values[RB_DELETE_FIXUP_LOOPS];
+	stats.deleteRotations = values[RB_DELETE_ROTATIONS];
+	for(int d = 0; d < RB_STATS_DEPTHS; d++)
+		stats.insertDepth[d] = values[RB_INSERT_DEPTH + d];
+	return stats;
+}
+
+#endif /* RB_STATS_H_ */
@@ -9,19 +9,141 @@
 #define RB_TREE_H_
 
 #include "RB_Node.h"
-#include <exception>
+#include "RB_FrozenTree.h"
+#include "RB_Dump.h"
+#include "RB_Stats.h"
+#include <iostream>
+#include <iterator>
+#include <functional>
+#include <type_traits>
+#include <atomic>
 
+/*
+ * Tells RB_Tree how to get at the key of a node of type T, which derives from
+ * RB_Node and has a member named key.  Compare must be default constructible.
+ *
+ * Trees that keep extra data in their nodes (subtree sizes, interval maxima) use
+ * their own traits with AUGMENTED set and an Update that recomputes a node's
+ * data from its children.  The tree calls Update on every node whose subtree
+ * changed, bottom up, so the data stays right through rotations and deletes.
+ */
+template <class T, class K = int, class Compare = std::less<K> >
+struct RB_KeyTraits
+{
+	typedef K Key;
+	static const bool AUGMENTED = false;
+
+	static const Key& KeyOf(const RB_Node* n) { return static_cast<const T*>(n)->key; }
+	static bool Less(const Key& a, const Key& b) { return Compare()(a, b); }
+	static void Update(RB_Node*) {}
+};
+
+//Traits::Less as a function object, for containers that take a Compare
+template <class Traits>
+struct RB_TraitsLess
+{
+	bool operator()(const typename Traits::Key& a, const typename Traits::Key& b) const
+	{
+		return Traits::Less(a, b);
+	}
+};
+
+/*
+ * Intrusive red-black tree (CLRS chapter 13) over nodes of type T.  The tree
+ * only links and unlinks nodes, it never allocates or frees them, so a node can
+ * be in at most one tree at a time and has to stay alive while it is in it.
+ * RB_Set wraps this with an owning, pool allocated version.
+ */
+template <class T, class Traits = RB_KeyTraits<T> >
 class RB_Tree
 {
 
 public:
+	typedef typename Traits::Key Key;
+	typedef RB_FrozenTree<Key, RB_TraitsLess<Traits> > Frozen;
+
+	/*
+	 * Bidirectional in-order iterator.  Steps follow the parent pointers, so
+	 * there is no recursion or stack and an increment is O(1) amortized.  A
+	 * node can be deleted once the iterator has moved past it.
+	 */
+	class iterator
+	{
+
+	public:
+		typedef std::bidirectional_iterator_tag iterator_category;
+		typedef T value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef T* pointer;
+		typedef T& reference;
+
+		iterator() : node(NULL), tree(NULL) {}
+
+		T& operator*() const { return *node; }
+		T* operator->() const { return node; }
+		//The current node, NULL at the end
+		T* Node() const { return node; }
+
+		iterator& operator++()
+		{
+			node = RB_Successor(node);
+			return *this;
+		}
+
+		iterator operator++(int)
+		{
+			iterator before = *this;
+			++*this;
+			return before;
+		}
+
+		//Stepping back from the end gives the last node
+		iterator& operator--()
+		{
+			node = node == NULL ? tree->RB_Maximum() : RB_Predecessor(node);
+			return *this;
+		}
+
+		iterator operator--(int)
+		{
+			iterator before = *this;
+			--*this;
+			return before;
+		}
+
+		bool operator==(const iterator& other) const { return node == other.node; }
+		bool operator!=(const iterator& other) const { return node != other.node; }
+
+	private:
+		friend class RB_Tree;
+		T* node;
+		const RB_Tree* tree;
+
+		iterator(T* node, const RB_Tree* tree) : node(node), tree(tree) {}
+	};
+
+	//The nodes with keys in [lo, hi), for range based for loops
+	class Range
+	{
+
+	public:
+		Range(iterator first, iterator last) : first(first), last(last) {}
+		iterator begin() const { return first; }
+		iterator end() const { return last; }
+		bool empty() const { return first == last; }
+
+	private:
+		iterator first;
+		iterator last;
+	};
 
 	RB_Tree(){
 			root = NULL;
+			count = 0;
 	}
 
+	//Nodes belong to the caller, they are left alone
 	~RB_Tree(){
-			delete root;
 	}
 
 	RB_Node* RB_GetRoot()
@@ -29,33 +151,372 @@ public:
 		return root;
 	}
 
-	void RB_Insert(RB_Node* z)
+	//O(1) unless a split left the size unknown, then one walk of the tree.
+	//Safe to call from several readers at once, they all store the same number.
+	size_t RB_Size() const
+	{
+		size_t n = count.load(std::memory_order_relaxed);
+		if(n == UNKNOWN_COUNT)
+		{
+			n = 0;
+			for(RB_Node* x = root == NULL ? NULL : Minimum(root); x != NULL; x = RB_Successor(static_cast<T*>(x)))
+				n++;
+			count.store(n, std::memory_order_relaxed);
+		}
+		return n;
+	}
+
+	bool RB_Empty() const
+	{
+		return root == NULL;
+	}
+
+	//Links z in, after any nodes with an equal key
+	void RB_Insert(T* z)
 	{
 		//Create an empty Node
 		RB_Node* y = NULL;
 		//Get our root
 		RB_Node* x = root;
+		bool goLeft = false;
+		RB_STATS_ONLY(unsigned depth = 0);
 
 		//While our root isn't null
 		while(x != NULL)
 		{
-			//Set x to the root
 			y = x;
+			RB_STATS_ONLY(depth++);
 			//Go left/Right maintaining BST conditions.
-			if(z->key < x->key)
+			goLeft = Traits::Less(Traits::KeyOf(z), Traits::KeyOf(x));
+			x = goLeft ? x->left : x->right;
+		}
+		//At this point, we have found a leaf where our node should go
+		RB_STATS_ONLY(RB_CountInsertDepth(depth));
+		Link(z, y, goLeft);
+	}
+
+	//Links z in unless its key is already present.  Returns the node that holds
+	//the key afterwards, which is z only if it was inserted.
+	T* RB_InsertUnique(T* z)
+	{
+		RB_Node* y = NULL;
+		RB_Node* x = root;
+		bool goLeft = false;
+		const Key& key = Traits::KeyOf(z);
+		RB_STATS_ONLY(unsigned depth = 0);
+
+		while(x != NULL)
+		{
+			y = x;
+			RB_STATS_ONLY(depth++);
+			if(Traits::Less(key, Traits::KeyOf(x)))
+			{
+				goLeft = true;
+				x = x->left;
+			}
+			else if(Traits::Less(Traits::KeyOf(x), key))
+			{
+				goLeft = false;
+				x = x->right;
+			}
+			else
+				return static_cast<T*>(x);
+		}
+		RB_STATS_ONLY(RB_CountInsertDepth(depth));
+		Link(z, y, goLeft);
+		return z;
+	}
+
+	//Unlinks z, which must be in this tree.  z itself is not touched beyond its links.
+	void RB_Delete(T* node)
+	{
+		RB_STATS_ONLY(RB_Count(RB_DELETES));
+		RB_Node* z = node;
+		RB_Node* y = z;
+		COLOR yOriginalColor = y->Color();
+		//x moves into y's old spot, xParent is its parent there since x may be NULL
+		RB_Node* x;
+		RB_Node* xParent;
+
+		if(z->left == NULL)
+		{
+			x = z->right;
+			xParent = z->Parent();
+			Transplant(z, z->right);
+		}
+		else if(z->right == NULL)
+		{
+			x = z->left;
+			xParent = z->Parent();
+			Transplant(z, z->left);
+		}
+		else
+		{
+			//Two children, z's successor takes its place
+			y = Minimum(z->right);
+			yOriginalColor = y->Color();
+			x = y->right;
+			if(y->Parent() == z)
+				xParent = y;
+			else
+			{
+				xParent = y->Parent();
+				Transplant(y, y->right);
+				y->right = z->right;
+				y->right->SetParent(y);
+			}
+			Transplant(z, y);
+			y->left = z->left;
+			y->left->SetParent(y);
+			y->SetColor(z->Color());
+		}
+		AdjustCount(-1);
+
+		//xParent is the lowest node whose subtree lost a node
+		if(Traits::AUGMENTED)
+			UpdatePath(xParent);
+		if(yOriginalColor == BLACK)
+			RB_Delete_Fixup(x, xParent);
+
+		z->left = NULL;
+		z->right = NULL;
+		z->SetParent(NULL);
+	}
+
+	//Forgets every node in O(1), the nodes themselves are not touched
+	void RB_Clear()
+	{
+		root = NULL;
+		count = 0;
+	}
+
+	//Some node with an equal key, NULL if there is none
+	T* RB_Find(const Key& key) const
+	{
+		RB_Node* x = root;
+		while(x != NULL)
+		{
+			if(Traits::Less(key, Traits::KeyOf(x)))
+				x = x->left;
+			else if(Traits::Less(Traits::KeyOf(x), key))
+				x = x->right;
+			else
+				return static_cast<T*>(x);
+		}
+		return NULL;
+	}
+
+	//First node whose key is not less than key, NULL if there is none
+	T* RB_LowerBound(const Key& key) const
+	{
+		RB_Node* x = root;
+		RB_Node* result = NULL;
+		while(x != NULL)
+		{
+			if(Traits::Less(Traits::KeyOf(x), key))
+				x = x->right;
+			else
+			{
+				result = x;
+				x = x->left;
+			}
+		}
+		return static_cast<T*>(result);
+	}
+
+	//First node whose key is greater than key, NULL if there is none
+	T* RB_UpperBound(const Key& key) const
+	{
+		RB_Node* x = root;
+		RB_Node* result = NULL;
+		while(x != NULL)
+		{
+			if(Traits::Less(key, Traits::KeyOf(x)))
 			{
+				result = x;
 				x = x->left;
 			}
 			else
 				x = x->right;
 		}
-		//At this point, we have found a leaf where our node should go
-		z->p = y;
+		return static_cast<T*>(result);
+	}
+
+	T* RB_Minimum() const
+	{
+		return root == NULL ? NULL : static_cast<T*>(Minimum(root));
+	}
+
+	T* RB_Maximum() const
+	{
+		return root == NULL ? NULL : static_cast<T*>(Maximum(root));
+	}
+
+	//Next node in key order, NULL after the last one
+	static T* RB_Successor(T* node)
+	{
+		RB_Node* x = node;
+		if(x->right != NULL)
+			return static_cast<T*>(Minimum(x->right));
+		RB_Node* y = x->Parent();
+		while(y != NULL && x == y->right)
+		{
+			x = y;
+			y = y->Parent();
+		}
+		return static_cast<T*>(y);
+	}
+
+	//Previous node in key order, NULL before the first one
+	static T* RB_Predecessor(T* node)
+	{
+		RB_Node* x = node;
+		if(x->left != NULL)
+			return static_cast<T*>(Maximum(x->left));
+		RB_Node* y = x->Parent();
+		while(y != NULL && x == y->left)
+		{
+			x = y;
+			y = y->Parent();
+		}
+		return static_cast<T*>(y);
+	}
+
+	iterator begin() const
+	{
+		return iterator(RB_Minimum(), this);
+	}
+
+	iterator end() const
+	{
+		return iterator(NULL, this);
+	}
+
+	Range RB_Range(const Key& lo, const Key& hi) const
+	{
+		if(!Traits::Less(lo, hi))
+			return Range(end(), end());
+		return Range(iterator(RB_LowerBound(lo), this), iterator(RB_LowerBound(hi), this));
+	}
+
+	/*
+	 * Writes every key in order to fd, one per line, through a large buffer.
+	 * Keys are formatted by RB_FormatKey, see RB_Dump.h.  Returns false on a
+	 * write error.
+	 */
+	bool RB_Dump(int fd) const
+	{
+		RB_FdWriter out(fd);
+		for(RB_Node* x = root == NULL ? NULL : Minimum(root); x != NULL; x = RB_Successor(static_cast<T*>(x)))
+		{
+			RB_FormatKey(out, Traits::KeyOf(x));
+			out.Put('\n');
+		}
+		return out.Flush();
+	}
+
+	//Writes the raw bytes of every key in order to fd, returns false on a write error
+	bool RB_DumpRaw(int fd) const
+	{
+		static_assert(std::is_trivially_copyable<Key>::value, "RB_DumpRaw writes keys as raw memory");
+		RB_FdWriter out(fd);
+		for(RB_Node* x = root == NULL ? NULL : Minimum(root); x != NULL; x = RB_Successor(static_cast<T*>(x)))
+			out.Write(&Traits::KeyOf(x), sizeof(Key));
+		return out.Flush();
+	}
+
+	//A read-only copy of the keys that is faster to search, see RB_FrozenTree.h
+	Frozen RB_Freeze() const
+	{
+		Frozen frozen;
+		RB_Node* x = root == NULL ? NULL : Minimum(root);
+		frozen.RB_Build(RB_Size(), [&x]() {
+			const Key& key = Traits::KeyOf(x);
+			x = RB_Successor(static_cast<T*>(x));
+			return key;
+		});
+		return frozen;
+	}
+
+	//Prints the keys under current in post order, climbing back up through
+	//the parent pointers so a tall subtree cannot overflow the stack
+	void ViewTree_PostOrder(RB_Node* current)
+	{
+		if(current == NULL)
+			return;
+		RB_Node* x = FirstPostOrder(current);
+		for(;;)
+		{
+			std::cout << Traits::KeyOf(x) << '\n';
+			if(x == current)
+				break;
+			RB_Node* p = x->Parent();
+			if(x == p->left && p->right != NULL)
+				x = FirstPostOrder(p->right);
+			else
+				x = p;
+		}
+		std::cout.flush();
+	}
+
+private:
+	template <class, class> friend class RB_JoinOps;
+
+	//Set after a split, when finding the size would take a walk of the tree
+	static const size_t UNKNOWN_COUNT = (size_t) -1;
+
+	RB_Node* root;
+	//Atomic only so that const RB_Size calls can fill it in concurrently.  Writers
+	//are single threaded, so they use plain relaxed loads and stores.
+	mutable std::atomic<size_t> count;
+
+	RB_Tree(const RB_Tree&);
+	RB_Tree& operator=(const RB_Tree&);
+
+	void AdjustCount(int delta)
+	{
+		size_t n = count.load(std::memory_order_relaxed);
+		if(n != UNKNOWN_COUNT)
+			count.store(n + delta, std::memory_order_relaxed);
+	}
+
+	//The first node a post order walk of the subtree under x visits
+	static RB_Node* FirstPostOrder(RB_Node* x)
+	{
+		for(;;)
+		{
+			if(x->left != NULL)
+				x = x->left;
+			else if(x->right != NULL)
+				x = x->right;
+			else
+				return x;
+		}
+	}
+
+	static RB_Node* Minimum(RB_Node* x)
+	{
+		while(x->left != NULL)
+			x = x->left;
+		return x;
+	}
+
+	static RB_Node* Maximum(RB_Node* x)
+	{
+		while(x->right != NULL)
+			x = x->right;
+		return x;
+	}
+
+	//Hangs z under y (or makes it the root) and restores the red-black properties
+	void Link(RB_Node* z, RB_Node* y, bool goLeft)
+	{
+		z->SetParent(y);
 		if(y == NULL)
 		{
 			root = z;
 		}
-		else if(z->key < y->key)
+		else if(goLeft)
 		{
 			y->left = z;
 		}
@@ -65,126 +526,229 @@ public:
 		}
 		z->left = NULL;
 		z->right = NULL;
-		z->color = RED;
+		z->SetColor(RED);
+		AdjustCount(1);
+		RB_STATS_ONLY(RB_Count(RB_INSERTS));
+		if(Traits::AUGMENTED)
+			UpdatePath(z);
 		RB_Insert_Fixup(z);
 	}
 
+	//Recomputes augmented data from x up to the root
+	void UpdatePath(RB_Node* x)
+	{
+		for(; x != NULL; x = x->Parent())
+			Traits::Update(x);
+	}
+
+	//Puts v where u is as far as u's parent is concerned
+	void Transplant(RB_Node* u, RB_Node* v)
+	{
+		if(u->Parent() == NULL)
+			root = v;
+		else if(u == u->Parent()->left)
+			u->Parent()->left = v;
+		else
+			u->Parent()->right = v;
+		if(v != NULL)
+			v->SetParent(u->Parent());
+	}
+
 	void Left_Rotate(RB_Node* x)
 	{
 		RB_Node* y = x->right;
 		x->right = y->left;
 		if(y->left != NULL)
 		{
-			y->left->p = x;
+			y->left->SetParent(x);
 		}
-		y->p = x->p;
-		if(x->p == NULL)
+		y->SetParent(x->Parent());
+		if(x->Parent() == NULL)
 			root = y;
-		else if(x == x->p->left)
+		else if(x == x->Parent()->left)
 		{
-			x->p->left = y;
+			x->Parent()->left = y;
 		}
 		else
-			x->p->right = y;
+			x->Parent()->right = y;
 		y->left = x;
-		x->p = y;
+		x->SetParent(y);
+		//x is now below y, so it goes first
+		if(Traits::AUGMENTED)
+		{
+			Traits::Update(x);
+			Traits::Update(y);
+		}
 	}
 
 	void Right_Rotate(RB_Node* x)
+	{
+		RB_Node* y = x->left;
+		x->left = y->right;
+		if(y->right != NULL)
 		{
-			RB_Node* y = x->left;
-			x->right = y->right;
-			if(y->right != NULL)
-			{
-				y->right->p = x;
-			}
-			y->p = x->p;
-			if(x->p == NULL)
-				root = y;
-			else if(x == x->p->right)
-			{
-				x->p->right = y;
-			}
-			else
-				x->p->left = y;
-			y->right = x;
-			x->p = y;
+			y->right->SetParent(x);
 		}
+		y->SetParent(x->Parent());
+		if(x->Parent() == NULL)
+			root = y;
+		else if(x == x->Parent()->right)
+		{
+			x->Parent()->right = y;
+		}
+		else
+			x->Parent()->left = y;
+		y->right = x;
+		x->SetParent(y);
+		if(Traits::AUGMENTED)
+		{
+			Traits::Update(x);
+			Traits::Update(y);
+		}
+	}
 
-	void ViewTree_PostOrder(RB_Node* current)
+	void RB_Insert_Fixup(RB_Node* z)
 	{
-		if(current == NULL)
-			return;
-		else
+		//The root is black, so a red parent always has a parent of its own
+		while(RB_IsRed(z->Parent()))
 		{
-			ViewTree_PostOrder(current->left);
-			ViewTree_PostOrder(current->right);
-			try{
-			cout << current->key << endl;
-			}catch(exception ex)
+			RB_STATS_ONLY(RB_Count(RB_INSERT_FIXUP_LOOPS));
+			RB_Node* parent = z->Parent();
+			RB_Node* grandparent = parent->Parent();
+			if(parent == grandparent->left)
+			{
+				RB_Node* y = grandparent->right;
+				if(RB_IsRed(y))
+				{
+					parent->SetColor(BLACK);
+					y->SetColor(BLACK);
+					grandparent->SetColor(RED);
+					z = grandparent;
+				}
+				else
+				{
+					if(z == parent->right)
+					{
+						z = parent;
+						RB_STATS_ONLY(RB_Count(RB_INSERT_ROTATIONS));
+						Left_Rotate(z);
+						parent = z->Parent();
+					}
+					parent->SetColor(BLACK);
+					grandparent->SetColor(RED);
+					RB_STATS_ONLY(RB_Count(RB_INSERT_ROTATIONS));
+					Right_Rotate(grandparent);
+				}
+			}
+			else
 			{
-				cout << "Current Key is Null" << endl;
+				RB_Node* y = grandparent->left;
+				if(RB_IsRed(y))
+				{
+					parent->SetColor(BLACK);
+					y->SetColor(BLACK);
+					grandparent->SetColor(RED);
+					z = grandparent;
+				}
+				else
+				{
+					if(z == parent->left)
+					{
+						z = parent;
+						RB_STATS_ONLY(RB_Count(RB_INSERT_ROTATIONS));
+						Right_Rotate(z);
+						parent = z->Parent();
+					}
+					parent->SetColor(BLACK);
+					grandparent->SetColor(RED);
+					RB_STATS_ONLY(RB_Count(RB_INSERT_ROTATIONS));
+					Left_Rotate(grandparent);
+				}
 			}
 		}
+		root->SetColor(BLACK);
 	}
 
-	void RB_Insert_Fixup(RB_Node* z)
+	//x carries an extra black, parent is x's parent since x may be NULL
+	void RB_Delete_Fixup(RB_Node* x, RB_Node* parent)
 	{
-		RB_Node* y = NULL;
-		while(z->p != NULL && (z->p->p != NULL) && z->p->color == RED)
+		while(x != root && !RB_IsRed(x))
 		{
-			if(z->p == z->p->p->left)
+			RB_STATS_ONLY(RB_Count(RB_DELETE_FIXUP_LOOPS));
+			if(x == parent->left)
 			{
-				y = z->p->p->right;
-
-				if(y!= NULL && y->color == RED)
+				RB_Node* w = parent->right;
+				if(RB_IsRed(w))
 				{
-					z->p->color = BLACK;
-					y->color = BLACK;
-					z->p->p->color = RED;
-					z = z->p->p;
+					w->SetColor(BLACK);
+					parent->SetColor(RED);
+					RB_STATS_ONLY(RB_Count(RB_DELETE_ROTATIONS));
+					Left_Rotate(parent);
+					w = parent->right;
 				}
-				else if(z == z->p->right)
+				if(!RB_IsRed(w->left) && !RB_IsRed(w->right))
 				{
-					z = z->p;
-					Left_Rotate(z);
+					w->SetColor(RED);
+					x = parent;
+					parent = x->Parent();
 				}
-				if(z->p != NULL && z->p->p != NULL)
+				else
 				{
-				z->p->color = BLACK;
-				z->p->p->color = RED;
-				Right_Rotate(z->p->p);
+					if(!RB_IsRed(w->right))
+					{
+						w->left->SetColor(BLACK);
+						w->SetColor(RED);
+						RB_STATS_ONLY(RB_Count(RB_DELETE_ROTATIONS));
+						Right_Rotate(w);
+						w = parent->right;
+					}
+					w->SetColor(parent->Color());
+					parent->SetColor(BLACK);
+					w->right->SetColor(BLACK);
+					RB_STATS_ONLY(RB_Count(RB_DELETE_ROTATIONS));
+					Left_Rotate(parent);
+					x = root;
 				}
 			}
 			else
 			{
-				y = z->p->p->left;
-				if(y!=NULL &&  y->color == RED)
+				RB_Node* w = parent->left;
+				if(RB_IsRed(w))
 				{
-					z->p->color = BLACK;
-					y->color = BLACK;
-					z->p->p->color = RED;
-					z = z->p->p;
+					w->SetColor(BLACK);
+					parent->SetColor(RED);
+					RB_STATS_ONLY(RB_Count(RB_DELETE_ROTATIONS));
+					Right_Rotate(parent);
+					w = parent->left;
 				}
-				else if(z == z->p->left)
+				if(!RB_IsRed(w->left) && !RB_IsRed(w->right))
 				{
-					z = z->p;
-					cout << "Calling Right Rotate" << endl;
-					Right_Rotate(z);
+					w->SetColor(RED);
+					x = parent;
+					parent = x->Parent();
 				}
-				if(z->p != NULL && z->p->p != NULL)
+				else
 				{
-					z->p->color = BLACK;
-					z->p->p->color = RED;
-					Left_Rotate(z->p->p);
+					if(!RB_IsRed(w->left))
+					{
+						w->right->SetColor(BLACK);
+						w->SetColor(RED);
+						RB_STATS_ONLY(RB_Count(RB_DELETE_ROTATIONS));
+						Left_Rotate(w);
+						w = parent->left;
+					}
+					w->SetColor(parent->Color());
+					parent->SetColor(BLACK);
+					w->left->SetColor(BLACK);
+					RB_STATS_ONLY(RB_Count(RB_DELETE_ROTATIONS));
+					Right_Rotate(parent);
+					x = root;
 				}
 			}
 		}
-
+		if(x != NULL)
+			x->SetColor(BLACK);
 	}
-
-private:
-	RB_Node* root;
 };
 
 #endif /* RB_TREE_H_ */
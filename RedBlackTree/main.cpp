@@ -6,56 +6,86 @@
  */
 #include <iostream>
 #include "RB_Tree.h"
+#include "RB_Set.h"
+#include "RB_OrderTree.h"
+#include "RB_PersistentTree.h"
+
+//Nodes carry their own key, the tree only links them
+class Item : public RB_Node
+{
+public:
+	Item(int k) : key(k) {}
+	int key;
+};
+
+class Sample : public RB_SizeNode
+{
+public:
+	Sample(int k) : key(k) {}
+	int key;
+};
 
 int main(int argc, char *argv[])
 {
-	RB_Node* node = new RB_Node();
-	RB_Node* node2 = new RB_Node();
-	RB_Node* node3 = new RB_Node();
-	RB_Node* node4 = new RB_Node();
-	RB_Node* node5 = new RB_Node();
-	RB_Node* node6 = new RB_Node();
-	RB_Node* node7 = new RB_Node();
-	RB_Node* node8 = new RB_Node();
-	RB_Node* node9 = new RB_Node();
-
-	node->key = 1;
-	node2->key = 2;
-	node3->key = 11;
-	node4->key = 14;
-	node5->key = 15;
-	node6->key = 7;
-	node7->key = 4;
-	node8->key = 5;
-	node9->key = 8;
-
-	RB_Tree* tree = new RB_Tree();
-	tree->RB_Insert(node);
-	tree->ViewTree_PostOrder(tree->RB_GetRoot());
+	int keys[] = { 1, 2, 11, 14, 15, 7, 4, 5, 8 };
+	const int n = sizeof(keys) / sizeof(keys[0]);
+	Item* nodes[n];
+	for(int i = 0; i < n; i++)
+		nodes[i] = new Item(keys[i]);
 
-	tree->RB_Insert(node2);
-	tree->ViewTree_PostOrder(tree->RB_GetRoot());
+	RB_Tree<Item>* tree = new RB_Tree<Item>();
+	for(int i = 0; i < n; i++)
+	{
+		tree->RB_Insert(nodes[i]);
+		tree->ViewTree_PostOrder(tree->RB_GetRoot());
+	}
 
-	tree->RB_Insert(node3);
+	cout << "Delete 11" << endl;
+	tree->RB_Delete(tree->RB_Find(11));
 	tree->ViewTree_PostOrder(tree->RB_GetRoot());
 
-	tree->RB_Insert(node4);
-	tree->ViewTree_PostOrder(tree->RB_GetRoot());
+	Item* first = tree->RB_LowerBound(6);
+	cout << "First key >= 6 is " << (first != NULL ? first->key : -1) << endl;
 
-	tree->RB_Insert(node5);
-	tree->ViewTree_PostOrder(tree->RB_GetRoot());
+	cout << "Keys in [4, 14):";
+	for(Item& item : tree->RB_Range(4, 14))
+		cout << " " << item.key;
+	cout << endl;
 
-	tree->RB_Insert(node6);
-	tree->ViewTree_PostOrder(tree->RB_GetRoot());
+	delete tree;
+	for(int i = 0; i < n; i++)
+		delete nodes[i];
 
-	tree->RB_Insert(node7);
-	tree->ViewTree_PostOrder(tree->RB_GetRoot());
+	RB_Set<int> set;
+	for(int i = 0; i < n; i++)
+		set.RB_Insert(keys[i]);
+	set.RB_Delete(14);
+	cout << "Set holds " << set.RB_Size() << " keys, contains 14: " << set.RB_Contains(14) << endl;
 
-	tree->RB_Insert(node8);
-	tree->ViewTree_PostOrder(tree->RB_GetRoot());
+	//Latency samples, the median and 90th percentile are a select away
+	int latencies[] = { 12, 7, 30, 7, 95, 14, 22, 9, 41, 18 };
+	const int samples = sizeof(latencies) / sizeof(latencies[0]);
+	Sample* sampleNodes[samples];
+	RB_OrderTree<Sample> histogram;
+	for(int i = 0; i < samples; i++)
+	{
+		sampleNodes[i] = new Sample(latencies[i]);
+		histogram.RB_Insert(sampleNodes[i]);
+	}
+	cout << "p50 " << histogram.RB_Select(samples / 2)->key << " p90 " << histogram.RB_Select(samples * 9 / 10)->key
+		<< ", samples in [10, 20): " << histogram.RB_CountRange(10, 20) << endl;
+	for(int i = 0; i < samples; i++)
+		delete sampleNodes[i];
 
-	tree->RB_Insert(node9);
-	tree->ViewTree_PostOrder(tree->RB_GetRoot());
+	//An old version stays readable after later writes
+	RB_PersistentTree<int> versions;
+	for(int i = 0; i < n; i++)
+		versions.RB_Insert(keys[i]);
+	{
+		RB_PersistentTree<int>::Snapshot before = versions.RB_Snapshot();
+		versions.RB_Delete(14);
+		cout << "Snapshot contains 14: " << before.RB_Contains(14) << ", current tree: " << versions.RB_Contains(14) << endl;
+	}
 
 	return 0;
 }
@@ -0,0 +1,899 @@
+/*
+ * Benchmark.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Timing and stress driver for the skip lists in this directory.
+ *
+ *  Build with
+ *
+ *  $ g++ -std=c++11 -O2 -pthread Benchmark.cpp -o skiplist_bench
+ *
+ *  and run as
+ *
+ *  skiplist_bench <mode> [args]
+ *
+ *  modes:
+ *	concurrent [max-threads] [ops-per-thread]	throughput of ConcurrentSkipList against a mutex protected std::set
+ *	stress [threads] [seconds]			hammers ConcurrentSkipList and checks the final contents
+ *	layout [keys]					build, lookup, teardown and memory of SkipList against the old two allocation node
+ *	bulk [keys]					cold start from sorted keys: insert one at a time against bulkLoad
+ *	finger [keys]					insert and search with and without a finger on sequential, near-sorted and random streams
+ *	fatnode [keys]					random lookups in SkipList against FatSkipList (add -march=native for the SIMD path)
+ *	batch [keys]					searchBatch with batch sizes 1 to 256 against one search per key
+ *	snapshot [keys] [seconds]			MvccSkipList ingest rate with and without a full snapshot scan running beside it
+ *	stats [keys]					random inserts and searches, then the SkipList::stats() counters (build with -DSKIPLIST_STATS)
+ *	memtable [operations] [directory]		MemTable puts, removes and flushes, then reopen and check recovery, also from a torn log tail
+ */
+
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <set>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <malloc.h>
+#include <map>
+#include <string>
+#include <stdio.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "SkipList.cpp"
+#include "ConcurrentSkipList.h"
+#include "FatSkipList.h"
+#include "MvccSkipList.h"
+#include "MemTable.h"
+
+using namespace std;
+
+//Small per-thread generator so the benchmark does not measure rand()'s lock
+class FastRandom{
+
+	private:
+		uint64_t state;
+
+	public:
+		FastRandom(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ull + 1) {}
+		uint64_t next()
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			return state;
+		}
+};
+
+static double secondsSince(chrono::steady_clock::time_point start)
+{
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+//Runs the same 80% search / 10% insert / 10% remove mix against any set type
+template <class Set>
+static double runMix(Set& set, int threads, int ops, int keyRange)
+{
+	atomic<bool> go(false);
+	vector<thread> workers;
+	for(int t = 0; t < threads; t++)
+	{
+		workers.push_back(thread([&set, &go, t, ops, keyRange]() {
+			FastRandom rng(t + 1);
+			while(!go.load())
+				;
+			for(int i = 0; i < ops; i++)
+			{
+				uint64_t r = rng.next();
+				int key = (int)((r >> 8) % keyRange);
+				int op = (int)(r & 0xFF) % 10;
+				if(op == 0)
+					set.insert(key);
+				else if(op == 1)
+					set.remove(key);
+				else
+					set.search(key);
+			}
+		}));
+	}
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	go.store(true);
+	for(size_t t = 0; t < workers.size(); t++)
+		workers[t].join();
+	return secondsSince(start);
+}
+
+//The single global mutex setup the concurrent list replaces
+class LockedSet{
+
+	private:
+		mutex lock;
+		set<int> keys;
+
+	public:
+		bool insert(int key) { lock_guard<mutex> g(lock); return keys.insert(key).second; }
+		bool remove(int key) { lock_guard<mutex> g(lock); return keys.erase(key) > 0; }
+		bool search(int key) { lock_guard<mutex> g(lock); return keys.count(key) > 0; }
+};
+
+static void benchConcurrent(int maxThreads, int ops)
+{
+	const int keyRange = 1 << 20;
+	vector<int> sweep;
+	for(int threads = 1; threads < maxThreads; threads *= 2)
+		sweep.push_back(threads);
+	sweep.push_back(maxThreads);
+
+	cout << "threads,structure,seconds,mops_per_sec" << endl;
+	for(size_t n = 0; n < sweep.size(); n++)
+	{
+		int threads = sweep[n];
+		{
+			ConcurrentSkipList list;
+			for(int k = 0; k < keyRange; k += 2)
+				list.insert(k);
+			double s = runMix(list, threads, ops, keyRange);
+			cout << threads << ",ConcurrentSkipList," << s << "," << (threads * (double)ops) / s / 1e6 << endl;
+		}
+		{
+			LockedSet locked;
+			for(int k = 0; k < keyRange; k += 2)
+				locked.insert(k);
+			double s = runMix(locked, threads, ops, keyRange);
+			cout << threads << ",mutex+std::set," << s << "," << (threads * (double)ops) / s / 1e6 << endl;
+		}
+	}
+}
+
+/*
+ * The node layout SkipList used before the arena: the node and its forward array
+ * are two separate heap allocations.  Kept here only so the layout benchmark has
+ * something to compare against.
+ */
+class LegacySkipList{
+
+	private:
+		struct Node{
+			int level;
+			int value;
+			Node** forward;
+			Node(int v, int l) : level(l), value(v), forward(new Node*[l + 1])
+			{
+				for(int i = 0; i <= l; i++)
+					forward[i] = NULL;
+			}
+			~Node() { delete[] forward; }
+		};
+
+		Node* head;
+		int level;
+
+	public:
+		LegacySkipList() : head(new Node(-1, SkipList::MAX_LEVEL)), level(0) {}
+		~LegacySkipList()
+		{
+			Node* x = head;
+			while(x != NULL)
+			{
+				Node* next = x->forward[0];
+				delete x;
+				x = next;
+			}
+		}
+
+		bool search(int key)
+		{
+			Node* x = head;
+			for(int i = level; i >= 0; i--)
+				while(x->forward[i] != NULL && x->forward[i]->value < key)
+					x = x->forward[i];
+			x = x->forward[0];
+			return x != NULL && x->value == key;
+		}
+
+		void insert(int key)
+		{
+			Node* update[SkipList::MAX_LEVEL + 1];
+			Node* x = head;
+			for(int i = level; i >= 0; i--)
+			{
+				while(x->forward[i] != NULL && x->forward[i]->value < key)
+					x = x->forward[i];
+				update[i] = x;
+			}
+			x = x->forward[0];
+			if(x != NULL && x->value == key)
+				return;
+			int l = 0;
+			while(rand() % 2 == 0 && l < SkipList::MAX_LEVEL)
+				l++;
+			if(l > level + 1)
+				l = level + 1;
+			for(int i = level + 1; i <= l; i++)
+				update[i] = head;
+			if(l > level)
+				level = l;
+			x = new Node(key, l);
+			for(int i = 0; i <= l; i++)
+			{
+				x->forward[i] = update[i]->forward[i];
+				update[i]->forward[i] = x;
+			}
+		}
+};
+
+static size_t heapInUse()
+{
+	struct mallinfo2 info = mallinfo2();
+	return info.uordblks + info.hblkhd;
+}
+
+//Inserts keys in random order, looks all of them up again, then tears the list down
+template <class List>
+static void runLayout(const char* name, const vector<int>& keys, const vector<int>& probes)
+{
+	size_t before = heapInUse();
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	List* list = new List();
+	for(size_t i = 0; i < keys.size(); i++)
+		list->insert(keys[i]);
+	double build = secondsSince(start);
+	size_t footprint = heapInUse() - before;
+
+	start = chrono::steady_clock::now();
+	long found = 0;
+	for(size_t i = 0; i < probes.size(); i++)
+		found += list->search(probes[i]) ? 1 : 0;
+	double lookup = secondsSince(start);
+
+	start = chrono::steady_clock::now();
+	delete list;
+	double teardown = secondsSince(start);
+
+	cout << name << "," << keys.size() << "," << build << "," << lookup * 1e9 / probes.size() << "," << teardown << ","
+		<< (double)footprint / keys.size() << "," << found << endl;
+}
+
+static void benchLayout(int n)
+{
+	vector<int> keys(n);
+	FastRandom rng(7);
+	for(int i = 0; i < n; i++)
+		keys[i] = i * 2;
+	for(int i = n - 1; i > 0; i--)
+		swap(keys[i], keys[rng.next() % (i + 1)]);
+	vector<int> probes(keys);
+	for(int i = n - 1; i > 0; i--)
+		swap(probes[i], probes[rng.next() % (i + 1)]);
+
+	cout << "structure,keys,build_s,lookup_ns,teardown_s,bytes_per_key,found" << endl;
+	srand(1);
+	runLayout<LegacySkipList>("two-allocation node", keys, probes);
+	srand(1);
+	runLayout<SkipList>("inline tower + arena", keys, probes);
+}
+
+static void benchBulk(int n)
+{
+	vector<int> keys(n);
+	for(int i = 0; i < n; i++)
+		keys[i] = i * 2;
+
+	cout << "method,keys,build_s,lookup_ns,found" << endl;
+	FastRandom rng(3);
+	vector<int> probes(n);
+	for(int i = 0; i < n; i++)
+		probes[i] = (int)(rng.next() % n) * 2;
+
+	{
+		//What startup did before: a full search and rand() per key
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		LegacySkipList list;
+		for(int i = 0; i < n; i++)
+			list.insert(keys[i]);
+		double build = secondsSince(start);
+		start = chrono::steady_clock::now();
+		long found = 0;
+		for(int i = 0; i < n; i++)
+			found += list.search(probes[i]) ? 1 : 0;
+		cout << "insert each (old)," << n << "," << build << "," << secondsSince(start) * 1e9 / n << "," << found << endl;
+	}
+	{
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		SkipList list;
+		for(int i = 0; i < n; i++)
+			list.insert(keys[i]);
+		double build = secondsSince(start);
+		start = chrono::steady_clock::now();
+		long found = 0;
+		for(int i = 0; i < n; i++)
+			found += list.search(probes[i]) ? 1 : 0;
+		cout << "insert each (tail append)," << n << "," << build << "," << secondsSince(start) * 1e9 / n << "," << found << endl;
+	}
+	{
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		SkipList list;
+		list.bulkLoad(keys.begin(), keys.end());
+		double build = secondsSince(start);
+		start = chrono::steady_clock::now();
+		long found = 0;
+		for(int i = 0; i < n; i++)
+			found += list.search(probes[i]) ? 1 : 0;
+		cout << "bulkLoad," << n << "," << build << "," << secondsSince(start) * 1e9 / n << "," << found << endl;
+	}
+}
+
+//Times inserting then searching a key stream, either from the head or through a finger
+static void runFinger(const char* stream, const vector<int>& keys, bool useFinger)
+{
+	SkipList list;
+	SkipList::Finger finger;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for(size_t i = 0; i < keys.size(); i++)
+	{
+		if(useFinger)
+			list.insert(keys[i], finger);
+		else
+			list.insert(keys[i]);
+	}
+	double build = secondsSince(start);
+
+	long found = 0;
+	start = chrono::steady_clock::now();
+	for(size_t i = 0; i < keys.size(); i++)
+	{
+		if(useFinger)
+			found += list.search(keys[i], finger) ? 1 : 0;
+		else
+			found += list.search(keys[i]) ? 1 : 0;
+	}
+	double lookup = secondsSince(start);
+	cout << stream << "," << (useFinger ? "finger" : "head") << "," << keys.size() << ","
+		<< build * 1e9 / keys.size() << "," << lookup * 1e9 / keys.size() << "," << found << endl;
+}
+
+static void benchFinger(int n)
+{
+	vector<int> sequential(n);
+	for(int i = 0; i < n; i++)
+		sequential[i] = i;
+
+	//Timestamps that arrive slightly out of order: each key is displaced by at most 32 slots
+	vector<int> nearSorted(sequential);
+	FastRandom rng(11);
+	for(int i = 0; i + 1 < n; i++)
+	{
+		int j = i + (int)(rng.next() % 32);
+		if(j < n)
+			swap(nearSorted[i], nearSorted[j]);
+	}
+
+	vector<int> random(sequential);
+	for(int i = n - 1; i > 0; i--)
+		swap(random[i], random[rng.next() % (i + 1)]);
+
+	cout << "stream,start,keys,insert_ns,search_ns,found" << endl;
+	srand(1);
+	runFinger("sequential", sequential, false);
+	srand(1);
+	runFinger("sequential", sequential, true);
+	srand(1);
+	runFinger("near-sorted", nearSorted, false);
+	srand(1);
+	runFinger("near-sorted", nearSorted, true);
+	srand(1);
+	runFinger("random", random, false);
+	srand(1);
+	runFinger("random", random, true);
+}
+
+template <class List>
+static void runLookups(const char* name, const vector<int>& keys, const vector<int>& probes)
+{
+	List list;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for(size_t i = 0; i < keys.size(); i++)
+		list.insert(keys[i]);
+	double build = secondsSince(start);
+
+	start = chrono::steady_clock::now();
+	long found = 0;
+	for(size_t i = 0; i < probes.size(); i++)
+		found += list.search(probes[i]) ? 1 : 0;
+	double lookup = secondsSince(start);
+	cout << name << "," << keys.size() << "," << build * 1e9 / keys.size() << "," << lookup * 1e9 / probes.size() << "," << found << endl;
+}
+
+static void benchFatNode(int n)
+{
+	FastRandom rng(5);
+	vector<int> keys(n);
+	for(int i = 0; i < n; i++)
+		keys[i] = (int)(rng.next() & 0x7FFFFFFF);
+	//Half the probes hit, half are random misses
+	vector<int> probes(n);
+	for(int i = 0; i < n; i++)
+		probes[i] = (i & 1) ? keys[rng.next() % n] : (int)(rng.next() & 0x7FFFFFFF);
+
+	cout << "structure,keys,insert_ns,lookup_ns,found" << endl;
+	srand(1);
+	runLookups<SkipList>("SkipList", keys, probes);
+	srand(1);
+	runLookups<FatSkipList>("FatSkipList", keys, probes);
+}
+
+static void benchBatch(int n)
+{
+	//Keys are spread out so the list is built by random inserts, not one linear bulk load,
+	//which would leave neighbouring nodes next to each other in memory
+	vector<int> keys(n);
+	for(int i = 0; i < n; i++)
+		keys[i] = i * 2;
+	FastRandom rng(9);
+	for(int i = n - 1; i > 0; i--)
+		swap(keys[i], keys[rng.next() % (i + 1)]);
+	SkipList list;
+	srand(1);
+	for(int i = 0; i < n; i++)
+		list.insert(keys[i]);
+
+	const int probesPerRun = 1 << 20;
+	vector<int> probes(probesPerRun);
+	for(int i = 0; i < probesPerRun; i++)
+		probes[i] = (int)(rng.next() % (2 * (uint64_t)n));
+	bool* results = new bool[probesPerRun];
+
+	cout << "batch,keys,footprint_mb,ns_per_lookup,found" << endl;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	long found = 0;
+	for(int i = 0; i < probesPerRun; i++)
+		found += list.search(probes[i]) ? 1 : 0;
+	cout << "search," << n << "," << list.memoryFootprint() / (1 << 20) << "," << secondsSince(start) * 1e9 / probesPerRun << "," << found << endl;
+
+	for(int batch = 1; batch <= 256; batch *= 2)
+	{
+		start = chrono::steady_clock::now();
+		for(int i = 0; i < probesPerRun; i += batch)
+			list.searchBatch(&probes[i], min(batch, probesPerRun - i), &results[i]);
+		double elapsed = secondsSince(start);
+		found = 0;
+		for(int i = 0; i < probesPerRun; i++)
+			found += results[i] ? 1 : 0;
+		cout << batch << "," << n << "," << list.memoryFootprint() / (1 << 20) << "," << elapsed * 1e9 / probesPerRun << "," << found << endl;
+	}
+	delete[] results;
+}
+
+/*
+ * One writer churns inserts and removes over the key range for the given time,
+ * first alone and then while another thread keeps taking snapshots and scanning
+ * the whole range.  Every snapshot is scanned twice and both passes must agree.
+ */
+static int benchSnapshot(int n, int seconds)
+{
+	MvccSkipList list;
+	for(int i = 0; i < n; i += 2)
+		list.insert(i);
+
+	cout << "scanner,writes_per_sec,scans,keys_per_scan" << endl;
+	for(int scanning = 0; scanning <= 1; scanning++)
+	{
+		atomic<bool> stop(false);
+		long scans = 0;
+		long scanned = 0;
+		long mismatches = 0;
+		thread scanner;
+		if(scanning)
+		{
+			scanner = thread([&]() {
+				while(!stop.load())
+				{
+					MvccSkipList::Snapshot snap = list.snapshot();
+					long first = 0;
+					long second = 0;
+					list.scan(snap, 0, n, [&](int) { first++; });
+					list.scan(snap, 0, n, [&](int) { second++; });
+					if(first != second)
+						mismatches++;
+					scans++;
+					scanned += first;
+				}
+			});
+		}
+
+		FastRandom rng(11);
+		long writes = 0;
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		while(secondsSince(start) < seconds)
+		{
+			for(int i = 0; i < 1024; i++, writes++)
+			{
+				int key = (int)(rng.next() % n);
+				if(rng.next() & 1)
+					list.insert(key);
+				else
+					list.remove(key);
+			}
+		}
+		double elapsed = secondsSince(start);
+		stop.store(true);
+		if(scanning)
+			scanner.join();
+
+		if(mismatches != 0)
+		{
+			cout << "snapshot scans disagreed " << mismatches << " times" << endl;
+			return 1;
+		}
+		cout << (scanning ? "yes" : "no") << "," << (long)(writes / elapsed) << "," << scans << "," << (scans ? scanned / scans : 0) << endl;
+	}
+	return 0;
+}
+
+/*
+ * Every thread owns the keys congruent to its id and keeps its own record of which
+ * of them should be present.  All threads also insert and remove a shared set of
+ * hot keys and search the whole range, so the owned keys are checked while their
+ * neighbours are being linked and unlinked around them.
+ */
+static int stressConcurrent(int threads, int seconds)
+{
+	const int ownedPerThread = 4096;
+	const int hotKeys = 64;
+	ConcurrentSkipList list;
+	atomic<bool> stop(false);
+	atomic<long> hotInserted(0);
+	atomic<long> hotRemoved(0);
+	vector<vector<char> > expected(threads, vector<char>(ownedPerThread, 0));
+	vector<thread> workers;
+
+	for(int t = 0; t < threads; t++)
+	{
+		workers.push_back(thread([&, t]() {
+			FastRandom rng(t + 17);
+			vector<char>& mine = expected[t];
+			while(!stop.load())
+			{
+				uint64_t r = rng.next();
+				int slot = (int)((r >> 8) % ownedPerThread);
+				int key = hotKeys + slot * threads + t;
+				switch(r % 4)
+				{
+					case 0:
+						if(list.insert(key) == (mine[slot] != 0))
+						{
+							cout << "insert(" << key << ") disagreed with the expected state" << endl;
+							exit(1);
+						}
+						mine[slot] = 1;
+						break;
+					case 1:
+						if(list.remove(key) != (mine[slot] != 0))
+						{
+							cout << "remove(" << key << ") disagreed with the expected state" << endl;
+							exit(1);
+						}
+						mine[slot] = 0;
+						break;
+					case 2:
+						if(list.search(key) != (mine[slot] != 0))
+						{
+							cout << "search(" << key << ") disagreed with the expected state" << endl;
+							exit(1);
+						}
+						break;
+					default:
+						int hot = (int)((r >> 40) % hotKeys);
+						if(r & 0x100)
+							hotInserted += list.insert(hot) ? 1 : 0;
+						else
+							hotRemoved += list.remove(hot) ? 1 : 0;
+						break;
+				}
+			}
+		}));
+	}
+
+	this_thread::sleep_for(chrono::seconds(seconds));
+	stop.store(true);
+	for(size_t t = 0; t < workers.size(); t++)
+		workers[t].join();
+
+	long hotPresent = 0;
+	for(int k = 0; k < hotKeys; k++)
+		hotPresent += list.search(k) ? 1 : 0;
+	if(hotInserted.load() - hotRemoved.load() != hotPresent)
+	{
+		cout << "hot keys: " << hotInserted.load() << " inserts, " << hotRemoved.load() << " removes, " << hotPresent << " present" << endl;
+		return 1;
+	}
+	for(int t = 0; t < threads; t++)
+	{
+		for(int slot = 0; slot < ownedPerThread; slot++)
+		{
+			int key = hotKeys + slot * threads + t;
+			if(list.search(key) != (expected[t][slot] != 0))
+			{
+				cout << "key " << key << " has the wrong final state" << endl;
+				return 1;
+			}
+		}
+	}
+	cout << "stress passed with " << threads << " threads, " << hotInserted.load() << " hot inserts" << endl;
+	return 0;
+}
+
+//Random inserts and lookups, with the time they took and the hot path counters
+static void benchStats(int n)
+{
+	SkipList list;
+	FastRandom rng(31);
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for(int i = 0; i < n; i++)
+		list.insert((int)(rng.next() % (2 * n)));
+	long found = 0;
+	for(int i = 0; i < n; i++)
+		found += list.search((int)(rng.next() % (2 * n))) ? 1 : 0;
+	double elapsed = secondsSince(start);
+
+	SkipListStats stats = SkipList::stats();
+	cout << "keys " << list.size() << ", found " << found << ", " << elapsed * 1e9 / (2 * n) << " ns per operation" << endl;
+	if(!stats.enabled)
+	{
+		cout << "counters are compiled out, rebuild with -DSKIPLIST_STATS" << endl;
+		return;
+	}
+	cout << "searches " << stats.searches << ", nodes compared per search " << stats.nodesPerSearch() << endl;
+	cout << "height,towers" << endl;
+	for(int l = 0; l < SKIPLIST_STATS_HEIGHTS; l++)
+	{
+		if(stats.towerHeight[l] != 0)
+			cout << l << "," << stats.towerHeight[l] << endl;
+	}
+	cout << "level0_steps,searches" << endl;
+	for(int w = 0; w < SKIPLIST_STATS_WALKS; w++)
+	{
+		if(stats.level0Walk[w] != 0)
+			cout << w << "," << stats.level0Walk[w] << endl;
+	}
+}
+
+//Names in directory that start with prefix, sorted
+static vector<string> listFiles(const string& directory, const char* prefix)
+{
+	vector<string> names;
+	DIR* dir = opendir(directory.c_str());
+	if(dir == NULL)
+		return names;
+	struct dirent* e;
+	while((e = readdir(dir)) != NULL)
+	{
+		if(strncmp(e->d_name, prefix, strlen(prefix)) == 0)
+			names.push_back(e->d_name);
+	}
+	closedir(dir);
+	sort(names.begin(), names.end());
+	return names;
+}
+
+//Every key in the model must read back with its value, and every other key in the range must be missing
+static bool checkMemTable(MemTable& table, const map<string, string>& expected, int keyRange, const char* phase)
+{
+	char key[32];
+	string value;
+	for(int k = 0; k < keyRange; k++)
+	{
+		snprintf(key, sizeof(key), "key-%08d", k);
+		map<string, string>::const_iterator it = expected.find(key);
+		bool found = table.get(key, &value);
+		if(found != (it != expected.end()) || (found && value != it->second))
+		{
+			cout << phase << ": " << key << " read back " << (found ? value : string("missing")) << ", expected "
+				<< (it != expected.end() ? it->second : string("missing")) << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+ * Random puts and removes through a MemTable small enough to flush every few
+ * thousand writes, mirrored in a std::map.  The table is then reopened and must
+ * recover the map from its runs and log.  Last, one more record is written, the
+ * log is cut in the middle of it and a half written run is left beside it, as a
+ * crash during a write and a flush would; the reopened table must drop both.
+ */
+static int benchMemTable(int n, string directory)
+{
+	bool scratch = directory.empty();
+	if(scratch)
+	{
+		char name[] = "/tmp/memtable-XXXXXX";
+		if(mkdtemp(name) == NULL)
+		{
+			cout << "cannot create a scratch directory" << endl;
+			return 1;
+		}
+		directory = name;
+	}
+
+	const int keyRange = n / 4 > 0 ? n / 4 : 1;
+	map<string, string> expected;
+	FastRandom rng(41);
+	char key[32];
+	char value[64];
+
+	cout << "phase,operations,seconds,runs" << endl;
+	{
+		MemTable table(directory, 64 << 10);
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		for(int i = 0; i < n; i++)
+		{
+			uint64_t r = rng.next();
+			snprintf(key, sizeof(key), "key-%08d", (int)((r >> 8) % keyRange));
+			if(r % 4 == 0)
+			{
+				table.remove(key);
+				expected.erase(key);
+			}
+			else
+			{
+				snprintf(value, sizeof(value), "value-%d-%llu", i, (unsigned long long)(r >> 40));
+				table.put(key, value);
+				expected[key] = value;
+			}
+			//An explicit flush now and then, on top of the size triggered ones
+			if(i % (n / 8 + 1) == n / 16)
+				table.flush();
+		}
+		cout << "write," << n << "," << secondsSince(start) << "," << table.runCount() << endl;
+		if(!checkMemTable(table, expected, keyRange, "before reopen"))
+			return 1;
+	}
+
+	{
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		MemTable table(directory, 64 << 10);
+		cout << "reopen," << keyRange << "," << secondsSince(start) << "," << table.runCount() << endl;
+		if(!checkMemTable(table, expected, keyRange, "after reopen"))
+			return 1;
+		table.put("torn", "this record loses its last bytes");
+	}
+
+	vector<string> logs = listFiles(directory, "wal-");
+	if(logs.empty())
+	{
+		cout << "no log left in " << directory << endl;
+		return 1;
+	}
+	string logPath = directory + "/" + logs.back();
+	struct stat st;
+	if(stat(logPath.c_str(), &st) != 0 || truncate(logPath.c_str(), st.st_size - 3) != 0)
+	{
+		cout << "cannot cut " << logPath << endl;
+		return 1;
+	}
+	string leftover = directory + "/run-999999.sst.tmp";
+	FILE* f = fopen(leftover.c_str(), "w");
+	if(f != NULL)
+	{
+		fputs("half a run", f);
+		fclose(f);
+	}
+
+	{
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		MemTable table(directory, 64 << 10);
+		cout << "torn tail reopen," << keyRange << "," << secondsSince(start) << "," << table.runCount() << endl;
+		if(!checkMemTable(table, expected, keyRange, "after torn tail"))
+			return 1;
+		if(table.get("torn", NULL))
+		{
+			cout << "the torn record was replayed" << endl;
+			return 1;
+		}
+		if(access(leftover.c_str(), F_OK) == 0)
+		{
+			cout << "the half written run was not removed" << endl;
+			return 1;
+		}
+		//The log was cut back to its last whole record, so appends follow it
+		table.put("after", "tail");
+	}
+	{
+		MemTable table(directory, 64 << 10);
+		string v;
+		if(!table.get("after", &v) || v != "tail" || !checkMemTable(table, expected, keyRange, "after append past the cut"))
+		{
+			cout << "write after the torn tail was not recovered" << endl;
+			return 1;
+		}
+	}
+
+	if(scratch)
+	{
+		vector<string> files = listFiles(directory, "");
+		for(size_t i = 0; i < files.size(); i++)
+		{
+			if(files[i] != "." && files[i] != "..")
+				unlink((directory + "/" + files[i]).c_str());
+		}
+		rmdir(directory.c_str());
+	}
+	cout << "memtable recovery verified, " << expected.size() << " live keys" << endl;
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	int cores = (int)thread::hardware_concurrency();
+	if(cores < 1)
+		cores = 1;
+
+	if(argc < 2)
+	{
+		cout << "Usage: " << argv[0] << " concurrent|stress|layout|bulk|finger|fatnode|batch|snapshot|stats|memtable [args]" << endl;
+		return 1;
+	}
+
+	if(strcmp(argv[1], "concurrent") == 0)
+	{
+		benchConcurrent(argc > 2 ? atoi(argv[2]) : cores, argc > 3 ? atoi(argv[3]) : 1000000);
+		return 0;
+	}
+	if(strcmp(argv[1], "stress") == 0)
+	{
+		return stressConcurrent(argc > 2 ? atoi(argv[2]) : cores * 2, argc > 3 ? atoi(argv[3]) : 5);
+	}
+
+	if(strcmp(argv[1], "layout") == 0)
+	{
+		benchLayout(argc > 2 ? atoi(argv[2]) : 1000000);
+		return 0;
+	}
+
+	if(strcmp(argv[1], "bulk") == 0)
+	{
+		benchBulk(argc > 2 ? atoi(argv[2]) : 4000000);
+		return 0;
+	}
+
+	if(strcmp(argv[1], "finger") == 0)
+	{
+		benchFinger(argc > 2 ? atoi(argv[2]) : 2000000);
+		return 0;
+	}
+
+	if(strcmp(argv[1], "fatnode") == 0)
+	{
+		benchFatNode(argc > 2 ? atoi(argv[2]) : 4000000);
+		return 0;
+	}
+
+	if(strcmp(argv[1], "batch") == 0)
+	{
+		benchBatch(argc > 2 ? atoi(argv[2]) : 8000000);
+		return 0;
+	}
+
+	if(strcmp(argv[1], "snapshot") == 0)
+	{
+		return benchSnapshot(argc > 2 ? atoi(argv[2]) : 1000000, argc > 3 ? atoi(argv[3]) : 3);
+	}
+
+	if(strcmp(argv[1], "stats") == 0)
+	{
+		benchStats(argc > 2 ? atoi(argv[2]) : 1000000);
+		return 0;
+	}
+
+	if(strcmp(argv[1], "memtable") == 0)
+	{
+		return benchMemTable(argc > 2 ? atoi(argv[2]) : 200000, argc > 3 ? argv[3] : "");
+	}
+
+	cout << "Unknown mode " << argv[1] << endl;
+	return 1;
+}
@@ -0,0 +1,278 @@
+/*
+ * ConcurrentSkipList.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Lock-free version of SkipList that can be shared between threads without a mutex.
+ *
+ *  Links are updated with compare-and-swap only.  The low bit of every forward
+ *  pointer is used as a mark: a node is logically deleted as soon as its level 0
+ *  link is marked, and later searches snip marked nodes out of the list as they
+ *  walk past them.  search never writes and never retries, so readers are never
+ *  blocked by writers.
+ *
+ *  Unlinked nodes are handed to the EpochManager and only freed once no thread
+ *  can still be looking at them.
+ */
+
+#ifndef CONCURRENTSKIPLIST_H_
+#define CONCURRENTSKIPLIST_H_
+
+#include <atomic>
+#include <new>
+#include <stdint.h>
+#include "../Common/EpochManager.h"
+
+class ConcurrentSkipListNode{
+
+	private:
+		int value;
+		int level;
+
+		ConcurrentSkipListNode(int v, int l) : value(v), level(l), owners(2) {}
+
+	public:
+		//Both the inserting and the removing thread have to be done with a node
+		//before it can be retired, whoever finishes last retires it.
+		std::atomic<int> owners;
+		//Tower of marked forward pointers, level+1 entries stored inline
+		std::atomic<uintptr_t> forward[1];
+
+		static ConcurrentSkipListNode* create(int v, int l)
+		{
+			void* mem = ::operator new(sizeof(ConcurrentSkipListNode) + l * sizeof(std::atomic<uintptr_t>));
+			ConcurrentSkipListNode* node = new (mem) ConcurrentSkipListNode(v, l);
+			for(int i = 0; i <= l; i++)
+				new (&node->forward[i]) std::atomic<uintptr_t>(0);
+			return node;
+		}
+
+		static void destroy(void* p)
+		{
+			::operator delete(p);
+		}
+
+		int getLevel(){return level;}
+		int getValue(){return value;}
+};
+
+class ConcurrentSkipList{
+
+	private:
+		typedef ConcurrentSkipListNode Node;
+
+		static const int MAX_LEVEL = 32;
+
+		Node* head;
+
+		static Node* pointer(uintptr_t link) { return reinterpret_cast<Node*>(link & ~(uintptr_t)1); }
+		static bool marked(uintptr_t link) { return (link & 1) != 0; }
+		static uintptr_t make(Node* n, bool mark) { return reinterpret_cast<uintptr_t>(n) | (mark ? 1 : 0); }
+
+		//rand() is not thread safe, so every thread keeps its own xorshift state
+		static int randomLevel()
+		{
+			static thread_local uint32_t state = 0;
+			if(state == 0)
+				state = (uint32_t)(reinterpret_cast<uintptr_t>(&state) >> 4) | 1;
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+
+			int newLevel = 0;
+			uint32_t bits = state;
+			while((bits & 1) == 0 && newLevel < MAX_LEVEL)
+			{
+				bits = (bits >> 1) | 0x80000000u;
+				newLevel++;
+			}
+			return newLevel;
+		}
+
+		//Fills preds/succs with the nodes around key on every level, snipping out
+		//any marked nodes on the way.  Returns true if an unmarked key was found.
+		bool find(int key, Node** preds, Node** succs)
+		{
+		retry:
+			Node* pred = head;
+			for(int i = MAX_LEVEL; i >= 0; i--)
+			{
+				Node* curr = pointer(pred->forward[i].load());
+				while(curr != NULL)
+				{
+					uintptr_t succ = curr->forward[i].load();
+					while(marked(succ))
+					{
+						//curr is being removed, unlink it from this level
+						uintptr_t expected = make(curr, false);
+						if(!pred->forward[i].compare_exchange_strong(expected, make(pointer(succ), false)))
+							goto retry;
+						curr = pointer(succ);
+						if(curr == NULL)
+							break;
+						succ = curr->forward[i].load();
+					}
+					if(curr != NULL && curr->getValue() < key)
+					{
+						pred = curr;
+						curr = pointer(succ);
+					}
+					else
+						break;
+				}
+				preds[i] = pred;
+				succs[i] = curr;
+			}
+			return succs[0] != NULL && succs[0]->getValue() == key;
+		}
+
+		//Drops one of the two owner references and retires the node on the last one
+		static void release(Node* n)
+		{
+			if(n->owners.fetch_sub(1) == 1)
+				EpochManager::instance().retire(n, &Node::destroy);
+		}
+
+	public:
+		ConcurrentSkipList()
+		{
+			head = Node::create(-1, MAX_LEVEL);
+		}
+
+		//Not safe to run while other threads are still using the list
+		~ConcurrentSkipList()
+		{
+			Node* x = head;
+			while(x != NULL)
+			{
+				Node* next = pointer(x->forward[0].load());
+				Node::destroy(x);
+				x = next;
+			}
+		}
+
+		bool search(int key)
+		{
+			EpochGuard guard;
+			Node* pred = head;
+			Node* curr = NULL;
+			for(int i = MAX_LEVEL; i >= 0; i--)
+			{
+				curr = pointer(pred->forward[i].load());
+				while(curr != NULL)
+				{
+					uintptr_t succ = curr->forward[i].load();
+					if(marked(succ))
+					{
+						//Walk past deleted nodes without helping to unlink them
+						curr = pointer(succ);
+						continue;
+					}
+					if(curr->getValue() < key)
+					{
+						pred = curr;
+						curr = pointer(succ);
+					}
+					else
+						break;
+				}
+			}
+			return curr != NULL && curr->getValue() == key && !marked(curr->forward[0].load());
+		}
+
+		//Returns false if the key was already present
+		bool insert(int key)
+		{
+			EpochGuard guard;
+			Node* preds[MAX_LEVEL + 1];
+			Node* succs[MAX_LEVEL + 1];
+			int l = randomLevel();
+			Node* x = NULL;
+
+			while(true)
+			{
+				if(find(key, preds, succs))
+				{
+					if(x != NULL)
+						Node::destroy(x);
+					return false;
+				}
+				if(x == NULL)
+					x = Node::create(key, l);
+				for(int i = 0; i <= l; i++)
+					x->forward[i].store(make(succs[i], false), std::memory_order_relaxed);
+
+				//Linking level 0 is what makes the key visible
+				uintptr_t expected = make(succs[0], false);
+				if(preds[0]->forward[0].compare_exchange_strong(expected, make(x, false)))
+					break;
+			}
+
+			for(int i = 1; i <= l; i++)
+			{
+				while(true)
+				{
+					uintptr_t link = x->forward[i].load();
+					//Someone started removing us, stop building the tower
+					if(marked(link))
+						goto done;
+					if(pointer(link) != succs[i] && !x->forward[i].compare_exchange_strong(link, make(succs[i], false)))
+						continue;
+
+					uintptr_t expected = make(succs[i], false);
+					if(preds[i]->forward[i].compare_exchange_strong(expected, make(x, false)))
+						break;
+
+					find(key, preds, succs);
+					if(succs[0] != x)
+						goto done;
+				}
+			}
+		done:
+			//If we were removed while linking, a level may have been linked after
+			//the remover cleaned up.  Search again so it gets unlinked.
+			if(marked(x->forward[0].load()))
+				find(key, preds, succs);
+			release(x);
+			return true;
+		}
+
+		//Returns false if the key was not present
+		bool remove(int key)
+		{
+			EpochGuard guard;
+			Node* preds[MAX_LEVEL + 1];
+			Node* succs[MAX_LEVEL + 1];
+
+			if(!find(key, preds, succs))
+				return false;
+
+			Node* victim = succs[0];
+			//Mark the upper levels first so nobody links past us from above
+			for(int i = victim->getLevel(); i >= 1; i--)
+			{
+				uintptr_t link = victim->forward[i].load();
+				while(!marked(link))
+				{
+					if(victim->forward[i].compare_exchange_weak(link, link | 1))
+						break;
+				}
+			}
+
+			//Whoever marks level 0 owns the removal
+			uintptr_t link = victim->forward[0].load();
+			while(true)
+			{
+				if(marked(link))
+					return false;
+				if(victim->forward[0].compare_exchange_weak(link, link | 1))
+					break;
+			}
+
+			find(key, preds, succs);
+			release(victim);
+			return true;
+		}
+};
+
+#endif /* CONCURRENTSKIPLIST_H_ */
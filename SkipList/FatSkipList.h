@@ -0,0 +1,298 @@
+/*
+ * FatSkipList.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Cache conscious version of SkipList where every node holds a small sorted block of keys.
+ *
+ *  A node's block is two cache lines of ints, so a lookup touches far fewer nodes
+ *  than in SkipList and the final step is a scan of a single block.  That scan
+ *  compares the key against the whole block at once with SSE2 or AVX2 when the
+ *  compiler targets them (build with -march=native) and a plain loop otherwise.
+ *
+ *  Upper levels index nodes by their smallest key.  A full node splits in half on
+ *  insert.  On remove a node absorbs its successor once the two together fit in
+ *  half a block, and a node that runs empty is unlinked.
+ *
+ *  The public interface matches SkipList: search, insert, remove and size.
+ */
+
+#ifndef FATSKIPLIST_H_
+#define FATSKIPLIST_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <new>
+#include "SkipListArena.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+class FatSkipList{
+
+	public:
+		static const int MAX_LEVEL = 32;
+		//Keys per node, 32 ints fill two 64 byte cache lines.  Must be a multiple of 8
+		//for the SIMD compare.
+		static const int BLOCK = 32;
+
+	private:
+		static_assert(BLOCK % 8 == 0, "BLOCK must be a multiple of 8");
+
+		//Block first so it starts the node's first cache line, tower last
+		struct Node{
+			//Sorted keys, slots past count hold INT_MAX so the SIMD compare can
+			//always look at the full block
+			int keys[BLOCK];
+			int count;
+			int level;
+			Node* forward[1];
+
+			static size_t bytesFor(int l)
+			{
+				return sizeof(Node) + l * sizeof(Node*);
+			}
+		};
+
+		Node* head[MAX_LEVEL + 1];
+		int level;
+		unsigned long keyCount;
+		SkipListArena arena;
+
+		FatSkipList(const FatSkipList&);
+		FatSkipList& operator=(const FatSkipList&);
+
+		int randomLevel()
+		{
+			int newLevel = 0;
+			for(newLevel = 0; rand() % 2 == 0; newLevel++)
+				;
+			if(newLevel > level + 1)
+				newLevel = level + 1;
+			if(newLevel > MAX_LEVEL)
+				return MAX_LEVEL;
+			return newLevel;
+		}
+
+		//Number of keys in the block that are smaller than key
+		static int countLess(const int* keys, int key)
+		{
+#if defined(__AVX2__)
+			__m256i k = _mm256_set1_epi32(key);
+			unsigned long mask = 0;
+			for(int i = 0; i < BLOCK; i += 8)
+			{
+				__m256i lt = _mm256_cmpgt_epi32(k, _mm256_loadu_si256((const __m256i*) (keys + i)));
+				mask |= (unsigned long) _mm256_movemask_ps(_mm256_castsi256_ps(lt)) << i;
+			}
+			return __builtin_popcountl(mask);
+#elif defined(__SSE2__)
+			__m128i k = _mm_set1_epi32(key);
+			unsigned long mask = 0;
+			for(int i = 0; i < BLOCK; i += 4)
+			{
+				__m128i lt = _mm_cmpgt_epi32(k, _mm_loadu_si128((const __m128i*) (keys + i)));
+				mask |= (unsigned long) _mm_movemask_ps(_mm_castsi128_ps(lt)) << i;
+			}
+			return __builtin_popcountl(mask);
+#else
+			int n = 0;
+			for(int i = 0; i < BLOCK; i++)
+				n += keys[i] < key ? 1 : 0;
+			return n;
+#endif
+		}
+
+		Node* createNode(int l)
+		{
+			Node* n = static_cast<Node*>(arena.allocate(Node::bytesFor(l)));
+			for(int i = 0; i < BLOCK; i++)
+				n->keys[i] = INT_MAX;
+			n->count = 0;
+			n->level = l;
+			for(int i = 0; i <= l; i++)
+				n->forward[i] = NULL;
+			return n;
+		}
+
+		/*
+		 * Walks down to the last node whose smallest key is <= key, or NULL if key is
+		 * smaller than every node.  update[i] gets the tower that was current on level i.
+		 */
+		Node* findNode(int key, Node*** update)
+		{
+			Node** x = head;
+			Node* node = NULL;
+			for(int i = level; i >= 0; i--)
+			{
+				while(x[i] != NULL && x[i]->keys[0] <= key)
+				{
+					node = x[i];
+					x = node->forward;
+				}
+				if(update != NULL)
+					update[i] = x;
+			}
+			return node;
+		}
+
+		//Fills preds with the towers that link to the node whose smallest key is min
+		void findPreds(int min, Node*** preds)
+		{
+			Node** x = head;
+			for(int i = level; i >= 0; i--)
+			{
+				while(x[i] != NULL && x[i]->keys[0] < min)
+					x = x[i]->forward;
+				preds[i] = x;
+			}
+		}
+
+		void linkAfter(Node* n, Node*** preds)
+		{
+			for(int i = 0; i <= n->level; i++)
+			{
+				n->forward[i] = preds[i][i];
+				preds[i][i] = n;
+			}
+		}
+
+		void unlink(Node* n)
+		{
+			Node** preds[MAX_LEVEL + 1];
+			findPreds(n->keys[0], preds);
+			for(int i = 0; i <= n->level; i++)
+			{
+				if(preds[i][i] == n)
+					preds[i][i] = n->forward[i];
+			}
+			arena.release(n, Node::bytesFor(n->level));
+			while(level > 0 && head[level] == NULL)
+				level--;
+		}
+
+		/*
+		 * Moves the upper half of the full node x into a new node right after it.
+		 * update is the search path that ended at x.
+		 */
+		Node* split(Node* x, Node*** update)
+		{
+			int l = randomLevel();
+			if(l > level)
+			{
+				for(int i = level + 1; i <= l; i++)
+					update[i] = head;
+				level = l;
+			}
+			Node* n = createNode(l);
+			int half = x->count / 2;
+			n->count = x->count - half;
+			memcpy(n->keys, x->keys + half, n->count * sizeof(int));
+			for(int i = half; i < BLOCK; i++)
+				x->keys[i] = INT_MAX;
+			x->count = half;
+
+			//On levels x reaches, n goes right after x, above that after the search path
+			Node** preds[MAX_LEVEL + 1];
+			for(int i = 0; i <= l; i++)
+				preds[i] = i <= x->level ? x->forward : update[i];
+			linkAfter(n, preds);
+			return n;
+		}
+
+	public:
+		FatSkipList() : level(0), keyCount(0)
+		{
+			for(int i = 0; i <= MAX_LEVEL; i++)
+				head[i] = NULL;
+		}
+
+		unsigned long size()
+		{
+			return keyCount;
+		}
+
+		bool search(int key)
+		{
+			Node* x = findNode(key, NULL);
+			if(x == NULL)
+				return false;
+			int i = countLess(x->keys, key);
+			return i < x->count && x->keys[i] == key;
+		}
+
+		void insert(int key)
+		{
+			Node** update[MAX_LEVEL + 1];
+			Node* x = findNode(key, update);
+
+			if(x == NULL)
+			{
+				//Smaller than every node, it becomes the new minimum of the first node
+				x = head[0];
+				if(x == NULL)
+				{
+					x = createNode(0);
+					linkAfter(x, update);
+				}
+			}
+
+			int i = countLess(x->keys, key);
+			if(i < x->count && x->keys[i] == key)
+			{
+				//Do nothing on duplicate
+				return;
+			}
+
+			if(x->count == BLOCK)
+			{
+				Node* n = split(x, update);
+				if(key >= n->keys[0])
+				{
+					x = n;
+					i = countLess(x->keys, key);
+				}
+			}
+
+			memmove(x->keys + i + 1, x->keys + i, (x->count - i) * sizeof(int));
+			x->keys[i] = key;
+			x->count++;
+			keyCount++;
+		}
+
+		void remove(int key)
+		{
+			Node* x = findNode(key, NULL);
+			if(x == NULL)
+				return;
+			int i = countLess(x->keys, key);
+			if(i >= x->count || x->keys[i] != key)
+				return;
+
+			//Unlink before touching keys[0], it is how the node is found
+			if(x->count == 1)
+			{
+				unlink(x);
+				keyCount--;
+				return;
+			}
+
+			memmove(x->keys + i, x->keys + i + 1, (x->count - i - 1) * sizeof(int));
+			x->count--;
+			x->keys[x->count] = INT_MAX;
+			keyCount--;
+
+			//Fold the next node in once both fit comfortably in one block
+			Node* next = x->forward[0];
+			if(next != NULL && x->count + next->count <= BLOCK / 2)
+			{
+				memcpy(x->keys + x->count, next->keys, next->count * sizeof(int));
+				x->count += next->count;
+				unlink(next);
+			}
+		}
+};
+
+#endif /* FATSKIPLIST_H_ */
@@ -0,0 +1,365 @@
+/*
+ * MemTable.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Durable write buffer on top of SkipListMap.
+ *
+ *  Every put and remove is appended to a WriteAheadLog before the call returns.
+ *  Writers that arrive while a log write is in flight queue their records behind
+ *  it, and the next writer to get the log writes the whole queue with a single
+ *  fdatasync (group commit).  The writer doing the sync also applies the batch to
+ *  the skip list, so once a record is durable it is in the table as well.
+ *
+ *  Once the table holds more than the flush threshold it is written out as an
+ *  immutable SortedRun, a fresh log is started and the old one is deleted.  Reads
+ *  check the table first and then the runs from newest to oldest.
+ *
+ *  Files in the directory:
+ *	wal-<n>.log	log for the table currently in memory
+ *	run-<n>.sst	table flushed from wal-<n>.log
+ *
+ *  Opening a directory maps every run and replays any logs into the table, which
+ *  is how the table is recovered after a crash.  Half written run-<n>.sst.tmp files
+ *  left by a crash during a flush are deleted.
+ */
+
+#ifndef MEMTABLE_H_
+#define MEMTABLE_H_
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <stdio.h>
+#include <dirent.h>
+#include "SkipListMap.h"
+#include "WriteAheadLog.h"
+#include "SortedRun.h"
+
+class MemTable{
+
+	public:
+		//Value slot in the skip list, removes are kept as tombstones so they can
+		//hide values that were already flushed to a run
+		struct Entry{
+			std::string value;
+			bool deleted;
+
+			Entry() : deleted(false) {}
+			Entry(std::string&& v, bool d) : value(std::move(v)), deleted(d) {}
+		};
+
+	private:
+		//A change waiting for the log, applied once its batch is durable
+		struct Pending{
+			WriteAheadLog::RecordType type;
+			std::string key;
+			std::string value;
+		};
+
+		typedef SkipListMap<std::string, Entry> Table;
+
+		std::string directory;
+		size_t flushThreshold;
+		Table* table;
+		//Approximate bytes of keys and values in table
+		size_t tableBytes;
+		//Oldest first
+		std::vector<SortedRun*> runs;
+		WriteAheadLog* log;
+		unsigned long fileNumber;
+		//Logs replayed at startup that are not the current log
+		std::vector<std::string> pendingOldLogs;
+
+		std::mutex lock;
+		std::condition_variable synced;
+		std::string pendingBytes;
+		std::vector<Pending> pending;
+		unsigned long appended;
+		unsigned long durable;
+		bool syncing;
+		std::string failure;
+
+		MemTable(const MemTable&);
+		MemTable& operator=(const MemTable&);
+
+		std::string fileName(const char* prefix, unsigned long n, const char* suffix)
+		{
+			char name[64];
+			snprintf(name, sizeof(name), "%s-%06lu.%s", prefix, n, suffix);
+			return directory + "/" + name;
+		}
+
+		void apply(WriteAheadLog::RecordType type, const std::string& key, std::string&& value)
+		{
+			bool deleted = type == WriteAheadLog::REMOVE;
+			Table::iterator it = table->find(key);
+			if(it != table->end())
+			{
+				tableBytes += value.size();
+				tableBytes -= it->second.value.size();
+				it->second.value = std::move(value);
+				it->second.deleted = deleted;
+				return;
+			}
+			tableBytes += key.size() + value.size() + sizeof(Entry);
+			table->emplace(key, std::move(value), deleted);
+		}
+
+		void syncDirectory()
+		{
+			int fd = ::open(directory.c_str(), O_RDONLY);
+			if(fd < 0)
+				throwSystemError("open", directory);
+			int rc = ::fsync(fd);
+			::close(fd);
+			if(rc != 0)
+				throwSystemError("fsync", directory);
+		}
+
+		/*
+		 * Writes everything queued so far to the log and applies it to the table.
+		 * Called with the lock held and syncing false; the lock is dropped during
+		 * the write so other writers can keep queueing behind us.
+		 */
+		void commitPending(std::unique_lock<std::mutex>& held)
+		{
+			syncing = true;
+			std::string batch;
+			batch.swap(pendingBytes);
+			std::vector<Pending> ops;
+			ops.swap(pending);
+			unsigned long upto = appended;
+
+			held.unlock();
+			try
+			{
+				log->append(batch);
+			}
+			catch(std::exception& e)
+			{
+				held.lock();
+				failure = e.what();
+				syncing = false;
+				synced.notify_all();
+				throw;
+			}
+			held.lock();
+
+			for(size_t i = 0; i < ops.size(); i++)
+				apply(ops[i].type, ops[i].key, std::move(ops[i].value));
+			durable = upto;
+			syncing = false;
+			synced.notify_all();
+		}
+
+		//Queues one change and returns once it is durable and visible in the table
+		void commit(WriteAheadLog::RecordType type, const std::string& key, const std::string& value)
+		{
+			std::unique_lock<std::mutex> held(lock);
+			if(!failure.empty())
+				throw std::runtime_error("memtable log failed earlier: " + failure);
+
+			WriteAheadLog::encode(pendingBytes, type, key, value);
+			Pending p;
+			p.type = type;
+			p.key = key;
+			p.value = value;
+			pending.push_back(std::move(p));
+			unsigned long ticket = ++appended;
+
+			while(durable < ticket)
+			{
+				if(!failure.empty())
+					throw std::runtime_error("memtable log failed: " + failure);
+				if(!syncing)
+					commitPending(held);
+				else
+					synced.wait(held);
+			}
+
+			if(tableBytes >= flushThreshold)
+				flushLocked(held);
+		}
+
+		void flushLocked(std::unique_lock<std::mutex>& held)
+		{
+			//Everything queued has to reach the table before it is written out
+			while(syncing || !pending.empty())
+			{
+				if(syncing)
+					synced.wait(held);
+				else
+					commitPending(held);
+			}
+			if(table->empty())
+				return;
+
+			std::string runPath = fileName("run", fileNumber, "sst");
+			SortedRun::write(runPath, table->begin(), table->end());
+			syncDirectory();
+			runs.push_back(new SortedRun(runPath));
+
+			//The run now holds everything in the old log
+			std::string oldLog = log->getPath();
+			delete log;
+			log = NULL;
+			fileNumber++;
+			log = new WriteAheadLog(fileName("wal", fileNumber, "log"));
+			syncDirectory();
+			::unlink(oldLog.c_str());
+
+			table->clear();
+			tableBytes = 0;
+		}
+
+		//Maps existing runs and replays existing logs, oldest first
+		void recover()
+		{
+			DIR* dir = ::opendir(directory.c_str());
+			if(dir == NULL)
+				throwSystemError("opendir", directory);
+			std::vector<unsigned long> runNumbers;
+			std::vector<unsigned long> logNumbers;
+			std::vector<std::string> leftovers;
+			struct dirent* e;
+			while((e = ::readdir(dir)) != NULL)
+			{
+				unsigned long n;
+				char tail;
+				//A run whose write was cut short, its log is still there to replay
+				if(strstr(e->d_name, ".tmp") != NULL)
+				{
+					if(strncmp(e->d_name, "run-", 4) == 0)
+						leftovers.push_back(directory + "/" + e->d_name);
+				}
+				else if(sscanf(e->d_name, "run-%lu.ss%c", &n, &tail) == 2 && tail == 't')
+					runNumbers.push_back(n);
+				else if(sscanf(e->d_name, "wal-%lu.lo%c", &n, &tail) == 2 && tail == 'g')
+					logNumbers.push_back(n);
+			}
+			::closedir(dir);
+			for(size_t i = 0; i < leftovers.size(); i++)
+				::unlink(leftovers[i].c_str());
+			std::sort(runNumbers.begin(), runNumbers.end());
+			std::sort(logNumbers.begin(), logNumbers.end());
+
+			fileNumber = 0;
+			for(size_t i = 0; i < runNumbers.size(); i++)
+			{
+				runs.push_back(new SortedRun(fileName("run", runNumbers[i], "sst")));
+				fileNumber = std::max(fileNumber, runNumbers[i] + 1);
+			}
+			for(size_t i = 0; i < logNumbers.size(); i++)
+			{
+				WriteAheadLog::replay(fileName("wal", logNumbers[i], "log"),
+					[this](WriteAheadLog::RecordType type, const std::string& key, std::string& value) {
+						apply(type, key, std::move(value));
+					});
+				fileNumber = std::max(fileNumber, logNumbers[i]);
+			}
+
+			//Keep appending to the newest log, the older ones go away with the next flush
+			log = new WriteAheadLog(fileName("wal", fileNumber, "log"));
+			for(size_t i = 0; i < logNumbers.size(); i++)
+			{
+				if(logNumbers[i] != fileNumber)
+					pendingOldLogs.push_back(fileName("wal", logNumbers[i], "log"));
+			}
+		}
+
+	public:
+		/*
+		 * Opens or creates a memtable in directory, which must already exist.
+		 * flushThreshold is the approximate number of key and value bytes held in
+		 * memory before the table is written out as a sorted run.
+		 */
+		explicit MemTable(const std::string& dir, size_t threshold = 4 << 20)
+			: directory(dir), flushThreshold(threshold), table(new Table()), tableBytes(0), log(NULL), fileNumber(0),
+			  appended(0), durable(0), syncing(false)
+		{
+			try
+			{
+				recover();
+				if(!pendingOldLogs.empty() || tableBytes >= flushThreshold)
+				{
+					std::unique_lock<std::mutex> held(lock);
+					flushLocked(held);
+					for(size_t i = 0; i < pendingOldLogs.size(); i++)
+						::unlink(pendingOldLogs[i].c_str());
+					pendingOldLogs.clear();
+				}
+			}
+			catch(...)
+			{
+				close();
+				throw;
+			}
+		}
+
+		~MemTable()
+		{
+			close();
+		}
+
+		void put(const std::string& key, const std::string& value)
+		{
+			commit(WriteAheadLog::PUT, key, value);
+		}
+
+		void remove(const std::string& key)
+		{
+			commit(WriteAheadLog::REMOVE, key, std::string());
+		}
+
+		//Returns false if key was never written or was removed
+		bool get(const std::string& key, std::string* value)
+		{
+			std::lock_guard<std::mutex> held(lock);
+			Table::iterator it = table->find(key);
+			if(it != table->end())
+			{
+				if(it->second.deleted)
+					return false;
+				if(value != NULL)
+					*value = it->second.value;
+				return true;
+			}
+			for(size_t i = runs.size(); i > 0; i--)
+			{
+				SortedRun::LookupResult r = runs[i - 1]->get(key, value);
+				if(r != SortedRun::NOT_FOUND)
+					return r == SortedRun::FOUND;
+			}
+			return false;
+		}
+
+		//Writes the table out as a sorted run now, regardless of its size
+		void flush()
+		{
+			std::unique_lock<std::mutex> held(lock);
+			flushLocked(held);
+		}
+
+		size_t runCount()
+		{
+			std::lock_guard<std::mutex> held(lock);
+			return runs.size();
+		}
+
+	private:
+		void close()
+		{
+			delete log;
+			log = NULL;
+			for(size_t i = 0; i < runs.size(); i++)
+				delete runs[i];
+			runs.clear();
+			delete table;
+			table = NULL;
+		}
+};
+
+#endif /* MEMTABLE_H_ */
@@ -0,0 +1,397 @@
+/*
+ * MvccSkipList.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Multi-version SkipList: readers scan a point-in-time snapshot while writers keep going.
+ *
+ *  Every write gets the next sequence number.  A key's node holds a chain of
+ *  versions, newest first, each tagged with the sequence number that created it
+ *  and whether it inserted or removed the key.  A reader with snapshot S sees the
+ *  newest version whose number is <= S.  Writers only ever prepend versions and
+ *  link new nodes with release stores, so readers never lock and never retry.
+ *
+ *  Writers are serialized by a mutex.  Versions that no live snapshot can reach
+ *  any more are trimmed on every write to their key, and a periodic sweep unlinks
+ *  keys whose last version is a removal.  Trimmed versions and unlinked nodes go
+ *  through the EpochManager, so a reader that is still walking them stays safe.
+ */
+
+#ifndef MVCCSKIPLIST_H_
+#define MVCCSKIPLIST_H_
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <new>
+#include <stdlib.h>
+#include <stdint.h>
+#include "../Common/EpochManager.h"
+
+class MvccSkipList{
+
+	public:
+		static const int MAX_LEVEL = 32;
+
+	private:
+		//Sweeps are amortized over at least this many writes
+		static const unsigned long SWEEP_MINIMUM = 1024;
+
+		struct Version{
+			uint64_t sequence;
+			bool deleted;
+			std::atomic<Version*> older;
+
+			Version(uint64_t s, bool d, Version* o) : sequence(s), deleted(d), older(o) {}
+
+			//Frees v and every version older than it
+			static void destroyChain(void* p)
+			{
+				Version* v = static_cast<Version*>(p);
+				while(v != NULL)
+				{
+					Version* next = v->older.load(std::memory_order_relaxed);
+					delete v;
+					v = next;
+				}
+			}
+		};
+
+		struct Node{
+			int key;
+			int level;
+			std::atomic<Version*> versions;
+			//Variable length tail, level+1 entries
+			std::atomic<Node*> forward[1];
+
+			static Node* create(int key, int l, Version* v)
+			{
+				void* mem = ::operator new(sizeof(Node) + l * sizeof(std::atomic<Node*>));
+				Node* n = static_cast<Node*>(mem);
+				n->key = key;
+				n->level = l;
+				new (&n->versions) std::atomic<Version*>(v);
+				for(int i = 0; i <= l; i++)
+					new (&n->forward[i]) std::atomic<Node*>(NULL);
+				return n;
+			}
+
+			static void destroy(void* p)
+			{
+				Node* n = static_cast<Node*>(p);
+				Version::destroyChain(n->versions.load(std::memory_order_relaxed));
+				::operator delete(n);
+			}
+		};
+
+		std::atomic<Node*> head[MAX_LEVEL + 1];
+		std::atomic<int> level;
+		//Highest sequence number whose version is fully published
+		std::atomic<uint64_t> lastSequence;
+
+		std::mutex writeLock;
+		unsigned long nodeCount;
+		unsigned long writesSinceSweep;
+
+		//Sequence numbers of live snapshots
+		std::mutex snapshotLock;
+		std::multiset<uint64_t> snapshots;
+
+		MvccSkipList(const MvccSkipList&);
+		MvccSkipList& operator=(const MvccSkipList&);
+
+		int randomLevel()
+		{
+			int newLevel = 0;
+			for(newLevel = 0; rand() % 2 == 0; newLevel++)
+				;
+			int top = level.load(std::memory_order_relaxed);
+			if(newLevel > top + 1)
+				newLevel = top + 1;
+			if(newLevel > MAX_LEVEL)
+				return MAX_LEVEL;
+			return newLevel;
+		}
+
+		/*
+		 * Oldest sequence number anyone can still read at.  Taken under the
+		 * snapshot lock so a snapshot being created right now is either counted
+		 * or will see a sequence number at least this new.
+		 */
+		uint64_t horizon()
+		{
+			std::lock_guard<std::mutex> held(snapshotLock);
+			uint64_t h = lastSequence.load(std::memory_order_acquire);
+			if(!snapshots.empty() && *snapshots.begin() < h)
+				h = *snapshots.begin();
+			return h;
+		}
+
+		//Newest version of n visible at sequence, NULL if n did not exist yet
+		static Version* visible(Node* n, uint64_t sequence)
+		{
+			Version* v = n->versions.load(std::memory_order_acquire);
+			while(v != NULL && v->sequence > sequence)
+				v = v->older.load(std::memory_order_acquire);
+			return v;
+		}
+
+		//Drops the versions older than the one everyone at horizon h sees
+		static void trim(Node* n, uint64_t h)
+		{
+			Version* keep = visible(n, h);
+			if(keep == NULL)
+				return;
+			Version* old = keep->older.load(std::memory_order_relaxed);
+			if(old != NULL)
+			{
+				keep->older.store(NULL, std::memory_order_release);
+				EpochManager::instance().retire(old, &Version::destroyChain);
+			}
+		}
+
+		//Writer side search, update gets the tower before key on every level
+		Node* findGreaterOrEqual(int key, std::atomic<Node*>** update)
+		{
+			std::atomic<Node*>* x = head;
+			for(int i = level.load(std::memory_order_relaxed); i >= 0; i--)
+			{
+				Node* next = x[i].load(std::memory_order_relaxed);
+				while(next != NULL && next->key < key)
+				{
+					x = next->forward;
+					next = x[i].load(std::memory_order_relaxed);
+				}
+				update[i] = x;
+			}
+			return x[0].load(std::memory_order_relaxed);
+		}
+
+		//Adds a version for key, called with writeLock held and inside an EpochGuard
+		bool write(int key, bool deleted)
+		{
+			std::atomic<Node*>* update[MAX_LEVEL + 1];
+			Node* x = findGreaterOrEqual(key, update);
+			uint64_t sequence = lastSequence.load(std::memory_order_relaxed) + 1;
+
+			if(x != NULL && x->key == key)
+			{
+				Version* newest = x->versions.load(std::memory_order_relaxed);
+				//Inserting a present key or removing a missing one changes nothing
+				if(newest->deleted == deleted)
+					return false;
+				x->versions.store(new Version(sequence, deleted, newest), std::memory_order_release);
+				lastSequence.store(sequence, std::memory_order_release);
+				trim(x, horizon());
+			}
+			else
+			{
+				if(deleted)
+					return false;
+				int l = randomLevel();
+				int top = level.load(std::memory_order_relaxed);
+				if(l > top)
+				{
+					for(int i = top + 1; i <= l; i++)
+						update[i] = head;
+					level.store(l, std::memory_order_release);
+				}
+				x = Node::create(key, l, new Version(sequence, false, NULL));
+				//Fill in our own links first, then publish bottom up
+				for(int i = 0; i <= l; i++)
+					x->forward[i].store(update[i][i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+				for(int i = 0; i <= l; i++)
+					update[i][i].store(x, std::memory_order_release);
+				nodeCount++;
+				lastSequence.store(sequence, std::memory_order_release);
+			}
+
+			if(++writesSinceSweep >= nodeCount && writesSinceSweep >= SWEEP_MINIMUM)
+				sweep();
+			return true;
+		}
+
+		/*
+		 * Walks the whole list, trims every version chain and unlinks keys whose
+		 * only remaining version is a removal nobody can see past.
+		 * Called with writeLock held and inside an EpochGuard.
+		 */
+		void sweep()
+		{
+			writesSinceSweep = 0;
+			uint64_t h = horizon();
+			std::atomic<Node*>* preds[MAX_LEVEL + 1];
+			int top = level.load(std::memory_order_relaxed);
+			for(int i = 0; i <= top; i++)
+				preds[i] = head;
+
+			Node* x = head[0].load(std::memory_order_relaxed);
+			while(x != NULL)
+			{
+				Node* next = x->forward[0].load(std::memory_order_relaxed);
+				trim(x, h);
+				Version* newest = x->versions.load(std::memory_order_relaxed);
+				if(newest->deleted && newest->sequence <= h)
+				{
+					for(int i = 0; i <= x->level; i++)
+						preds[i][i].store(x->forward[i].load(std::memory_order_relaxed), std::memory_order_release);
+					EpochManager::instance().retire(x, &Node::destroy);
+					nodeCount--;
+				}
+				else
+				{
+					for(int i = 0; i <= x->level; i++)
+						preds[i] = x->forward;
+				}
+				x = next;
+			}
+
+			while(top > 0 && head[top].load(std::memory_order_relaxed) == NULL)
+				top--;
+			level.store(top, std::memory_order_release);
+		}
+
+	public:
+		/*
+		 * A point-in-time view of the list.  Reads through it ignore every write
+		 * made after it was taken.  Versions it can see are kept alive until it is
+		 * destroyed.  It must not outlive the list.
+		 */
+		class Snapshot{
+
+			private:
+				friend class MvccSkipList;
+				MvccSkipList* list;
+				uint64_t sequence;
+
+				Snapshot(MvccSkipList* l, uint64_t s) : list(l), sequence(s) {}
+				Snapshot(const Snapshot&);
+				Snapshot& operator=(const Snapshot&);
+
+			public:
+				Snapshot(Snapshot&& other) : list(other.list), sequence(other.sequence)
+				{
+					other.list = NULL;
+				}
+
+				~Snapshot()
+				{
+					if(list != NULL)
+						list->release(sequence);
+				}
+
+				uint64_t getSequence() const { return sequence; }
+		};
+
+		MvccSkipList() : level(0), lastSequence(0), nodeCount(0), writesSinceSweep(0)
+		{
+			for(int i = 0; i <= MAX_LEVEL; i++)
+				head[i].store(NULL);
+		}
+
+		//Not safe while readers, writers or snapshots are still around
+		~MvccSkipList()
+		{
+			Node* x = head[0].load();
+			while(x != NULL)
+			{
+				Node* next = x->forward[0].load();
+				Node::destroy(x);
+				x = next;
+			}
+		}
+
+		Snapshot snapshot()
+		{
+			std::lock_guard<std::mutex> held(snapshotLock);
+			uint64_t s = lastSequence.load(std::memory_order_acquire);
+			snapshots.insert(s);
+			return Snapshot(this, s);
+		}
+
+		//Returns false if the key was already present
+		bool insert(int key)
+		{
+			std::lock_guard<std::mutex> held(writeLock);
+			EpochGuard guard;
+			return write(key, false);
+		}
+
+		//Returns false if the key was not present
+		bool remove(int key)
+		{
+			std::lock_guard<std::mutex> held(writeLock);
+			EpochGuard guard;
+			return write(key, true);
+		}
+
+		//Trims every key's versions and drops removed keys right away
+		void collectGarbage()
+		{
+			std::lock_guard<std::mutex> held(writeLock);
+			EpochGuard guard;
+			sweep();
+		}
+
+		//Reads the newest version of key
+		bool search(int key)
+		{
+			EpochGuard guard;
+			return searchAt(key, UINT64_MAX);
+		}
+
+		bool search(int key, const Snapshot& snap)
+		{
+			EpochGuard guard;
+			return searchAt(key, snap.sequence);
+		}
+
+		//Calls fn(key) for every key in [lo, hi) that was present when snap was taken
+		template <class Function>
+		void scan(const Snapshot& snap, int lo, int hi, Function fn)
+		{
+			EpochGuard guard;
+			Node* x = seek(lo);
+			while(x != NULL && x->key < hi)
+			{
+				Version* v = visible(x, snap.sequence);
+				if(v != NULL && !v->deleted)
+					fn(x->key);
+				x = x->forward[0].load(std::memory_order_acquire);
+			}
+		}
+
+	private:
+		//First node whose key is >= key, caller holds an EpochGuard
+		Node* seek(int key)
+		{
+			std::atomic<Node*>* x = head;
+			for(int i = level.load(std::memory_order_acquire); i >= 0; i--)
+			{
+				Node* next = x[i].load(std::memory_order_acquire);
+				while(next != NULL && next->key < key)
+				{
+					x = next->forward;
+					next = x[i].load(std::memory_order_acquire);
+				}
+			}
+			return x[0].load(std::memory_order_acquire);
+		}
+
+		bool searchAt(int key, uint64_t sequence)
+		{
+			Node* x = seek(key);
+			if(x == NULL || x->key != key)
+				return false;
+			Version* v = visible(x, sequence);
+			return v != NULL && !v->deleted;
+		}
+
+		void release(uint64_t sequence)
+		{
+			std::lock_guard<std::mutex> held(snapshotLock);
+			snapshots.erase(snapshots.find(sequence));
+		}
+};
+
+#endif /* MVCCSKIPLIST_H_ */
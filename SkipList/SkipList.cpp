@@ -7,74 +7,340 @@
 
 #include <iostream>
 #include <stdlib.h>
+#include <stdexcept>
+#include "SkipListArena.h"
+#include "SkipListStats.h"
 
 using namespace std;
 
+/*
+ * Nodes keep their forward tower inline after the value, so a node is a single
+ * allocation and stepping to a node brings its links into cache with it.
+ * Nodes are created through create() with the list's arena and must never be
+ * built on the stack or with new.
+ *
+ * Behind the forward tower sits a tower of widths: width()[i] is how many level 0
+ * steps forward[i] skips.  A NULL link counts as pointing one past the last node.
+ */
 class SkipListNode{
 
 	private:
 		int level;
 		int value;
 
+		SkipListNode(int v, int l)
+		{
+			setValue(v);
+			setLevel(l);
+			for (int i=0; i<=l; i++)
+			{
+				forward[i] = NULL;
+				width()[i] = 1;
+			}
+		}
 
 	public:
-		SkipListNode()
+		//Size of a node whose tower has entries 0..l
+		static size_t bytesFor(int l)
 		{
-				setLevel(32);
-				forward = new SkipListNode* [level+1];
-			        for (int i=0; i<=level; i++)
-			            forward[i] = NULL;
+			return sizeof(SkipListNode) + l * sizeof(SkipListNode*) + (l + 1) * sizeof(unsigned long);
 		}
 
-		SkipListNode(int v, int l)
+		static SkipListNode* create(SkipListArena& arena, int v, int l)
 		{
-			setValue(v);
-			setLevel(l);
-			forward = new SkipListNode* [level+1];
-			for (int i=0; i<=level; i++)
-				forward[i] = NULL;
+			return new (arena.allocate(bytesFor(l))) SkipListNode(v, l);
 		}
-		~SkipListNode()
+
+		static void destroy(SkipListArena& arena, SkipListNode* node)
 		{
-			delete[] forward;
+			arena.release(node, bytesFor(node->getLevel()));
 		}
+
 		void setValue(int v){value = v;}
 		int getLevel(){return level;}
-		int setLevel(int l){level = l;}
+		void setLevel(int l){level = l;}
 		int getValue(){return value;}
-		SkipListNode** forward;
+		unsigned long* width(){return reinterpret_cast<unsigned long*>(forward + level + 1);}
+		//Variable length tail, level+1 entries followed by the widths
+		SkipListNode* forward[1];
 
 
 };
 
 class SkipList{
 
+	public:
+		//Tallest tower a node can have, the head is always built this tall
+		static const int MAX_LEVEL = 32;
+		static_assert(MAX_LEVEL < SKIPLIST_STATS_HEIGHTS, "SkipListStats needs a bucket for every tower height");
+		//Descents searchBatch keeps in flight at once
+		static const int BATCH_GROUP = 16;
+
+		/*
+		 * Remembers where the last search or insert through it ended, so the next
+		 * one close by can start from there instead of from the head.  Reaching a
+		 * key d positions away costs O(log d) rather than O(log n).
+		 *
+		 * Any change to the list made without the finger makes it stale, and the
+		 * next use falls back to a search from the head.
+		 */
+		class Finger{
+
+			private:
+				friend class SkipList;
+				//Last node before the previous key on every level
+				SkipListNode* update[MAX_LEVEL + 1];
+				//Position of each update node, the head being position 0
+				unsigned long rank[MAX_LEVEL + 1];
+				//List version the update vector was computed against
+				unsigned long version;
+
+			public:
+				Finger() : version(0) {}
+		};
+
 	private:
+		SkipListArena arena;
 		SkipListNode* head;
-		SkipListNode* tail;
-		SkipListNode* front;
-		SkipListNode* rear;
+		//Highest level currently in use.  The head's own tower is always MAX_LEVEL tall.
 		int level;
+		//Number of keys in the list
+		unsigned long count;
+		//Last node on every level, head where a level is empty.  Lets keys larger
+		//than the current maximum be appended without searching.
+		SkipListNode* tail[MAX_LEVEL + 1];
+		//Bumped on every change so fingers can tell they are stale
+		unsigned long version;
 		int randomLevel() {
 			 int newLevel = 0;
 			 for(newLevel=0; rand() % 2 == 0; newLevel++)
 				 ;
-			 if(newLevel > head->getLevel() + 1)
-				 newLevel = head->getLevel() + 1;
+			 if(newLevel > level + 1)
+				 newLevel = level + 1;
 
-			 if(newLevel > 32)
-				 return 32;
+			 if(newLevel > MAX_LEVEL)
+				 newLevel = MAX_LEVEL;
 
+			 SKIPLIST_STATS_ONLY(SkipListStats::countTower(newLevel));
 			 return newLevel;
 
 		}
 
+		//Tower height for the n-th key of a bulk load: every 2^l-th key reaches level l,
+		//which is the shape a perfectly balanced skip list has.
+		static int bulkLevel(unsigned long n)
+		{
+			int l = 0;
+			while((n & 1) == 0 && l < MAX_LEVEL)
+			{
+				n >>= 1;
+				l++;
+			}
+			return l;
+		}
+
+		//Links a new node of level l after the current last node.
+		//key must be larger than every key in the list.
+		void append(int key, int l)
+		{
+			version++;
+			if(l > level)
+			{
+				for(int i = level + 1; i <= l; i++)
+					head->width()[i] = count + 1;
+				level = l;
+			}
+			SkipListNode* x = SkipListNode::create(arena, key, l);
+			count++;
+			for(int i = 0; i <= l; i++)
+			{
+				//The tail's width to NULL is exactly the distance to the new last node
+				tail[i]->forward[i] = x;
+				tail[i] = x;
+			}
+			for(int i = l + 1; i <= level; i++)
+				tail[i]->width()[i]++;
+		}
+
+		/*
+		 * Links key in after the nodes in Update unless it is already there.
+		 * rank[i] is the position of Update[i], the head being position 0.
+		 */
+		void link(int key, SkipListNode** Update, unsigned long* rank)
+		{
+			SkipListNode* x = Update[0]->forward[0];
+			if(x != NULL && x->getValue() == key)
+			{
+				//Do nothing on duplicate
+				return;
+			}
+
+			version++;
+			int l = randomLevel();
+
+			if(l > level)
+			{
+				for(int i = level + 1; i <= l; i++)
+				{
+					Update[i] = head;
+					rank[i] = 0;
+					head->width()[i] = count + 1;
+				}
+				level = l;
+			}
+
+			x = SkipListNode::create(arena, key, l);
+			count++;
+			for(int i = 0; i <= l; i++)
+			{
+				//Split the width of the link we are cutting in two
+				unsigned long before = rank[0] - rank[i] + 1;
+				x->width()[i] = Update[i]->width()[i] + 1 - before;
+				Update[i]->width()[i] = before;
+				x->forward[i] = Update[i]->forward[i];
+				Update[i]->forward[i] = x;
+				if(x->forward[i] == NULL)
+					tail[i] = x;
+			}
+			//Links above the new node now jump over one more node
+			for(int i = l + 1; i <= level; i++)
+				Update[i]->width()[i]++;
+		}
+
+		/*
+		 * Brings the finger's update vector to key.  From the old position we climb
+		 * until the level's predecessor is before key and the next level does not
+		 * jump past it, then descend as usual.  Levels above the one we climbed to
+		 * are still correct for key, so they are left alone.
+		 */
+		void moveFinger(int key, Finger& finger)
+		{
+			SkipListNode** update = finger.update;
+			unsigned long* rank = finger.rank;
+			int top = level;
+			int j = 0;
+
+			if(finger.version != version)
+			{
+				j = top;
+				update[top] = head;
+				rank[top] = 0;
+			}
+			else
+			{
+				while(j < top)
+				{
+					if(update[j] != head && update[j]->getValue() >= key)
+					{
+						j++;
+						continue;
+					}
+					SkipListNode* next = update[j+1]->forward[j+1];
+					if(next != NULL && next->getValue() < key)
+					{
+						j++;
+						continue;
+					}
+					break;
+				}
+				if(update[j] != head && update[j]->getValue() >= key)
+				{
+					update[j] = head;
+					rank[j] = 0;
+				}
+			}
+
+			SkipListNode* x = update[j];
+			unsigned long r = rank[j];
+			for(int i = j; i >= 0; i--)
+			{
+				while(x->forward[i] != NULL && x->forward[i]->getValue() < key)
+				{
+					r += x->width()[i];
+					x = x->forward[i];
+				}
+				update[i] = x;
+				rank[i] = r;
+			}
+			finger.version = version;
+		}
+
+		/*
+		 * One step of a batched descent: finds the next node whose value has to be
+		 * compared and prefetches it.  Returns false once the descent has finished,
+		 * with result set.
+		 */
+		bool advance(int key, int& i, SkipListNode* x, SkipListNode*& next, bool& result)
+		{
+			SkipListNode* known = next;
+			while(i >= 0)
+			{
+				SkipListNode* candidate = x->forward[i];
+				//NULL or the node we just found too large, drop a level without waiting
+				if(candidate == NULL || candidate == known)
+				{
+					i--;
+					continue;
+				}
+				__builtin_prefetch(candidate);
+				next = candidate;
+				return true;
+			}
+			result = known != NULL && known->getValue() == key;
+			return false;
+		}
+
+		SkipList(const SkipList&);
+		SkipList& operator=(const SkipList&);
+
 	public:
 		SkipList() {
-		          head = new SkipListNode(-1, 0);
-		      }
+			//The head owns a full tower, its level only tracks how much of it is in use
+			head = SkipListNode::create(arena, -1, MAX_LEVEL);
+			level = 0;
+			count = 0;
+			for(int i = 0; i <= MAX_LEVEL; i++)
+				tail[i] = head;
+			version = 1;
+		}
 
+		//Every node lives in the arena, so there is nothing to walk
+		~SkipList() {}
 
+		/*
+		 * Loads keys from an ascending range in a single pass.  Each key is appended
+		 * at the tail with a deterministic tower height, so loading n keys into an
+		 * empty list is O(n) and yields a perfectly balanced list.  Keys that are not
+		 * larger than the current maximum, whether from unsorted input or from keys
+		 * already in the list, fall back to a normal insert.
+		 */
+		template <class InputIterator>
+		void bulkLoad(InputIterator first, InputIterator last)
+		{
+			unsigned long n = 0;
+			for(; first != last; ++first)
+			{
+				int key = *first;
+				if(tail[0] != head && key <= tail[0]->getValue())
+				{
+					insert(key);
+					continue;
+				}
+				append(key, bulkLevel(++n));
+			}
+		}
+
+		//Hot path counts over every list and thread, see SkipListStats.h
+		static SkipListStats stats()
+		{
+			return SkipListStats::snapshot();
+		}
+
+		//Bytes held by the list, including free slots waiting for reuse
+		size_t memoryFootprint()
+		{
+			return arena.bytesReserved();
+		}
 
 			bool search(int key)
 			{
@@ -83,14 +349,20 @@ class SkipList{
 				else
 				{
 					SkipListNode* temp = head;
-					for(int i = head->getLevel(); i >=0; i--)
+					SKIPLIST_STATS_ONLY(unsigned long visited = 0, level0Steps = 0);
+					for(int i = level; i >=0; i--)
 					{
 						while((temp->forward[i] != NULL) && (temp->forward[i]->getValue() < key))
 						{
 							temp = temp->forward[i];
+							SKIPLIST_STATS_ONLY(visited++);
+							SKIPLIST_STATS_ONLY(if(i == 0) level0Steps++);
 						}
+						//The node that ended this level was compared too
+						SKIPLIST_STATS_ONLY(if(temp->forward[i] != NULL) visited++);
 
 					}
+					SKIPLIST_STATS_ONLY(SkipListStats::countSearch(visited, level0Steps));
 					temp = temp->forward[0];
 					if((temp != NULL) && (temp->getValue() == key))
 					{
@@ -107,8 +379,8 @@ class SkipList{
 				 else
 				 {
 					 SkipListNode* temp = head;
-					 SkipListNode** update = new SkipListNode*[32];
-					 for(int i = head->getLevel(); i >=0; i--)
+					 SkipListNode* update[MAX_LEVEL + 1];
+					 for(int i = level; i >=0; i--)
 					 {
 						 while((temp->forward[i] != NULL) && (temp->forward[i]->getValue() < key))
 						 {
@@ -119,16 +391,25 @@ class SkipList{
 						 temp = temp->forward[0];
 						 if((temp != NULL) && (temp->getValue() == key))
 						 {
-							 for(int i = 0; i <= head->getLevel(); i++)
+							 for(int i = 0; i <= level; i++)
 							 {
 								 if(update[i]->forward[i] == temp)
+								 {
+									 update[i]->width()[i] += temp->width()[i] - 1;
 									 update[i]->forward[i] = temp->forward[i];
+								 }
+								 else
+									 update[i]->width()[i]--;
+								 if(tail[i] == temp)
+									 tail[i] = update[i];
 							 }
-							 delete temp;
+							 SkipListNode::destroy(arena, temp);
+							 count--;
+							 version++;
 
-							 while((head->getLevel() > 0) && head->forward[head->getLevel()] == NULL)
+							 while((level > 0) && head->forward[level] == NULL)
 							 {
-								 head->setLevel(head->getLevel()-1);
+								 level--;
 						 }
 					 }
 				 }
@@ -136,46 +417,174 @@ class SkipList{
 
 		      void insert(int key)
 		      {
-		    	  SkipListNode* Update[32];
+		    	  //Larger than everything in the list, no need to search
+		    	  if(tail[0] != head && key > tail[0]->getValue())
+		    	  {
+		    		  append(key, randomLevel());
+		    		  return;
+		    	  }
+
+		    	  SkipListNode* Update[MAX_LEVEL + 1];
+		    	  unsigned long rank[MAX_LEVEL + 1];
 		    	  SkipListNode* x = head;
-		    	  for(int i = head->getLevel(); i >= 0; i--)
+		    	  unsigned long r = 0;
+		    	  for(int i = level; i >= 0; i--)
 		    	  {
 		    		  while(x->forward[i] != NULL && x->forward[i]->getValue() < key)
 		    		  {
+		    			  r += x->width()[i];
 		    			  x = x->forward[i];
 		    		  }
 		    		  Update[i] = x;
+		    		  rank[i] = r;
 		    	  }
 
-		    	  x = x->forward[0];
-		    	  if(x != NULL && x->getValue() == key)
+		    	  link(key, Update, rank);
+		      }
+
+		      //Same as search, but starts from where the finger last left off
+		      bool search(int key, Finger& finger)
+		      {
+		    	  moveFinger(key, finger);
+		    	  SkipListNode* x = finger.update[0]->forward[0];
+		    	  return x != NULL && x->getValue() == key;
+		      }
+
+		      //Same as insert, but starts from where the finger last left off
+		      void insert(int key, Finger& finger)
+		      {
+		    	  moveFinger(key, finger);
+		    	  link(key, finger.update, finger.rank);
+		    	  finger.version = version;
+		      }
+
+		      /*
+		       * Looks up n keys at once, results[i] is set to search(keys[i]).
+		       *
+		       * Up to BATCH_GROUP descents run side by side.  Each one advances a single
+		       * step, prefetches the node it needs to look at next and hands over to the
+		       * next descent, so by the time it comes around again that node is usually
+		       * in cache.  The misses of the whole group overlap instead of being paid
+		       * one after another.
+		       */
+		      void searchBatch(const int* keys, int n, bool* results)
+		      {
+		    	  struct Descent{
+		    		  int key;
+		    		  int index;
+		    		  int level;
+		    		  SkipListNode* x;
+		    		  //Node whose value we are waiting on, NULL when the descent is done
+		    		  SkipListNode* next;
+		    	  };
+		    	  //Nothing to overlap with a single key
+		    	  if(n == 1)
 		    	  {
-		    		  //Do nothing on duplicate
+		    		  results[0] = search(keys[0]);
 		    		  return;
 		    	  }
-		    	  else
+
+		    	  Descent group[BATCH_GROUP];
+		    	  int active = 0;
+		    	  int started = 0;
+
+		    	  while(started < n || active > 0)
 		    	  {
-		    		  int l = randomLevel();
+		    		  //Top the group up with new keys
+		    		  while(active < BATCH_GROUP && started < n)
+		    		  {
+		    			  Descent& d = group[active];
+		    			  d.key = keys[started];
+		    			  d.index = started++;
+		    			  d.level = level;
+		    			  d.x = head;
+		    			  d.next = NULL;
+		    			  if(advance(d.key, d.level, d.x, d.next, results[d.index]))
+		    				  active++;
+		    		  }
 
-		    		  if(l > head->getLevel())
+		    		  for(int g = 0; g < active; )
 		    		  {
-		    			  for(int i = (head->getLevel())+1; i<= l; i++)
+		    			  Descent& d = group[g];
+		    			  //Compare against the node prefetched last round
+		    			  if(d.next->getValue() < d.key)
+		    				  d.x = d.next;
+		    			  else if(d.level-- == 0)
+		    			  {
+		    				  results[d.index] = d.next->getValue() == d.key;
+		    				  group[g] = group[--active];
+		    				  continue;
+		    			  }
+		    			  if(!advance(d.key, d.level, d.x, d.next, results[d.index]))
 		    			  {
-		    				  Update[i] = head;
-		    				  Update[i]->setLevel(i);
+		    				  group[g] = group[--active];
+		    				  continue;
 		    			  }
+		    			  g++;
 		    		  }
+		    	  }
+		      }
 
-		    	  x = new SkipListNode(key, l);
-		    	  for(int i = 0; i <= l; i++)
+		      unsigned long size()
+		      {
+		    	  return count;
+		      }
+
+		      //Number of keys strictly less than key
+		      unsigned long rank(int key)
+		      {
+		    	  SkipListNode* x = head;
+		    	  unsigned long r = 0;
+		    	  for(int i = level; i >= 0; i--)
 		    	  {
-		    		  	  x->forward[i] = Update[i]->forward[i];
-		    		  	  Update[i]->forward[i] = x;
+		    		  while(x->forward[i] != NULL && x->forward[i]->getValue() < key)
+		    		  {
+		    			  r += x->width()[i];
+		    			  x = x->forward[i];
+		    		  }
 		    	  }
+		    	  return r;
+		      }
+
+		      //The k-th smallest key, counting from 0.  Throws out_of_range if k >= size().
+		      int select(unsigned long k)
+		      {
+		    	  if(k >= count)
+		    		  throw out_of_range("SkipList::select");
+		    	  SkipListNode* x = head;
+		    	  unsigned long position = 0;
+		    	  for(int i = level; i >= 0; i--)
+		    	  {
+		    		  while(x->forward[i] != NULL && position + x->width()[i] <= k + 1)
+		    		  {
+		    			  position += x->width()[i];
+		    			  x = x->forward[i];
+		    		  }
 		    	  }
+		    	  return x->getValue();
+		      }
 
+		      //Number of keys in [lo, hi)
+		      unsigned long countRange(int lo, int hi)
+		      {
+		    	  if(hi <= lo)
+		    		  return 0;
+		    	  return rank(hi) - rank(lo);
 		      }
 
-};
+		      //Calls visit(key) for every key in [lo, hi), in order along level 0
+		      template <class Visitor>
+		      void scan(int lo, int hi, Visitor visit)
+		      {
+		    	  SkipListNode* x = head;
+		    	  for(int i = level; i >= 0; i--)
+		    	  {
+		    		  while(x->forward[i] != NULL && x->forward[i]->getValue() < lo)
+		    			  x = x->forward[i];
+		    	  }
+		    	  for(x = x->forward[0]; x != NULL && x->getValue() < hi; x = x->forward[0])
+		    		  visit(x->getValue());
+		      }
 
+};
 
@@ -0,0 +1,207 @@
+/*
+ * SkipListArena.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Block allocator for skip list nodes.
+ *
+ *  Nodes are carved out of large blocks with a bump pointer, so building a list
+ *  with millions of keys only costs a handful of calls to malloc.  Freed nodes go
+ *  onto a free list for their size class and are handed out again before the
+ *  block is bumped.  Nothing is returned to the system until the arena itself is
+ *  destroyed, which releases every block at once.
+ *
+ *  Allocations larger than the biggest size class get a malloc of their own and
+ *  are freed by release, so nodes holding large values do not pile up under churn.
+ *  Every allocation is aligned to the alignment the arena was built with.
+ */
+
+#ifndef SKIPLISTARENA_H_
+#define SKIPLISTARENA_H_
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <new>
+
+class SkipListArena{
+
+	private:
+		//Smallest alignment and size class step, which is enough for pointers and ints
+		static const size_t ALIGNMENT = 8;
+		//Largest size handled by the free lists.  A full 33 level SkipListNode tower with
+		//its widths is 536 bytes, so every tower height is recycled.
+		static const size_t MAX_CLASS_BYTES = 1024;
+		static const size_t CLASS_COUNT = MAX_CLASS_BYTES / ALIGNMENT + 1;
+		static const size_t FIRST_BLOCK_BYTES = 4096;
+		static const size_t MAX_BLOCK_BYTES = 4 << 20;
+
+		//Blocks are chained through a header at their start so they can all be freed
+		struct Block{
+			Block* next;
+			size_t size;
+		};
+
+		struct FreeSlot{
+			FreeSlot* next;
+		};
+
+		//Sits right before an oversized allocation, the list lets clear() find them all
+		struct Large{
+			Large* prev;
+			Large* next;
+			void* base;
+			size_t size;
+		};
+
+		size_t alignment;
+		Block* blocks;
+		Large* large;
+		char* cursor;
+		char* limit;
+		size_t nextBlockBytes;
+		size_t reserved;
+		size_t used;
+		FreeSlot* freeLists[CLASS_COUNT];
+
+		SkipListArena(const SkipListArena&);
+		SkipListArena& operator=(const SkipListArena&);
+
+		size_t roundUp(size_t bytes) const
+		{
+			return (bytes + alignment - 1) & ~(alignment - 1);
+		}
+
+		char* alignUp(char* p) const
+		{
+			return (char*) (((size_t) p + alignment - 1) & ~(alignment - 1));
+		}
+
+		void grow(size_t bytes)
+		{
+			size_t size = nextBlockBytes;
+			while(size < bytes + sizeof(Block) + alignment)
+				size *= 2;
+			if(nextBlockBytes < MAX_BLOCK_BYTES)
+				nextBlockBytes *= 2;
+
+			Block* b = (Block*) malloc(size);
+			if(b == NULL)
+				throw std::bad_alloc();
+			b->next = blocks;
+			b->size = size;
+			blocks = b;
+			reserved += size;
+			cursor = alignUp((char*) b + sizeof(Block));
+			limit = (char*) b + size;
+		}
+
+		void* allocateLarge(size_t bytes)
+		{
+			size_t size = sizeof(Large) + alignment + bytes;
+			char* base = (char*) malloc(size);
+			if(base == NULL)
+				throw std::bad_alloc();
+			char* p = alignUp(base + sizeof(Large));
+			Large* h = (Large*) p - 1;
+			h->base = base;
+			h->size = size;
+			h->prev = NULL;
+			h->next = large;
+			if(large != NULL)
+				large->prev = h;
+			large = h;
+			reserved += size;
+			return p;
+		}
+
+		void releaseLarge(void* p)
+		{
+			Large* h = (Large*) p - 1;
+			if(h->prev != NULL)
+				h->prev->next = h->next;
+			else
+				large = h->next;
+			if(h->next != NULL)
+				h->next->prev = h->prev;
+			reserved -= h->size;
+			free(h->base);
+		}
+
+	public:
+		//align must be a power of two, pass alignof the node type
+		explicit SkipListArena(size_t align = ALIGNMENT) : alignment(align > ALIGNMENT ? align : ALIGNMENT), blocks(NULL), large(NULL), cursor(NULL), limit(NULL), nextBlockBytes(FIRST_BLOCK_BYTES), reserved(0), used(0)
+		{
+			for(size_t i = 0; i < CLASS_COUNT; i++)
+				freeLists[i] = NULL;
+		}
+
+		~SkipListArena()
+		{
+			clear();
+		}
+
+		void* allocate(size_t bytes)
+		{
+			bytes = roundUp(bytes);
+			used += bytes;
+			if(bytes > MAX_CLASS_BYTES)
+				return allocateLarge(bytes);
+			FreeSlot* slot = freeLists[bytes / ALIGNMENT];
+			if(slot != NULL)
+			{
+				freeLists[bytes / ALIGNMENT] = slot->next;
+				return slot;
+			}
+			if(cursor == NULL || (size_t)(limit - cursor) < bytes)
+				grow(bytes);
+			void* p = cursor;
+			cursor += bytes;
+			return p;
+		}
+
+		//bytes must match what was passed to allocate
+		void release(void* p, size_t bytes)
+		{
+			bytes = roundUp(bytes);
+			used -= bytes;
+			if(bytes > MAX_CLASS_BYTES)
+			{
+				releaseLarge(p);
+				return;
+			}
+			FreeSlot* slot = (FreeSlot*) p;
+			slot->next = freeLists[bytes / ALIGNMENT];
+			freeLists[bytes / ALIGNMENT] = slot;
+		}
+
+		//Drops every allocation at once
+		void clear()
+		{
+			while(blocks != NULL)
+			{
+				Block* next = blocks->next;
+				free(blocks);
+				blocks = next;
+			}
+			while(large != NULL)
+			{
+				Large* next = large->next;
+				free(large->base);
+				large = next;
+			}
+			for(size_t i = 0; i < CLASS_COUNT; i++)
+				freeLists[i] = NULL;
+			cursor = NULL;
+			limit = NULL;
+			nextBlockBytes = FIRST_BLOCK_BYTES;
+			reserved = 0;
+			used = 0;
+		}
+
+		//Bytes obtained from malloc
+		size_t bytesReserved() const { return reserved; }
+		//Bytes currently handed out to live nodes
+		size_t bytesUsed() const { return used; }
+};
+
+#endif /* SKIPLISTARENA_H_ */
@@ -0,0 +1,313 @@
+/*
+ * SkipListMap.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Ordered key/value map built the same way as SkipList, for any key type and comparator.
+ *
+ *  Entries live inside the nodes as std::pair<const Key, Value>, so find, lower_bound
+ *  and the iterators hand back references straight into the list without copying.
+ *  Iterators walk level 0, which makes a range scan a plain linked list walk:
+ *
+ *	for(SkipListMap<K, V>::iterator it = map.lower_bound(lo); it != map.end() && it->first < hi; ++it)
+ *
+ *  Values are moved or constructed in place on insert, never copied.
+ */
+
+#ifndef SKIPLISTMAP_H_
+#define SKIPLISTMAP_H_
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <tuple>
+#include <new>
+#include "SkipListArena.h"
+
+template <class Key, class Value, class Compare = std::less<Key> >
+class SkipListMap{
+
+	public:
+		typedef Key key_type;
+		typedef Value mapped_type;
+		typedef std::pair<const Key, Value> value_type;
+		typedef Compare key_compare;
+		typedef size_t size_type;
+
+		static const int MAX_LEVEL = 32;
+
+	private:
+		//Entry first, then the variable length tower
+		struct Node{
+			value_type entry;
+			int level;
+			Node* forward[1];
+
+			template <class K, class... Args>
+			Node(int l, K&& key, Args&&... args)
+				: entry(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<Args>(args)...)), level(l)
+			{
+				for(int i = 0; i <= l; i++)
+					forward[i] = NULL;
+			}
+
+			static size_t bytesFor(int l)
+			{
+				return sizeof(Node) + l * sizeof(Node*);
+			}
+		};
+
+		//The head is only a tower, so a search walks arrays of forward pointers
+		//and never needs a dummy key.
+		Node* head[MAX_LEVEL + 1];
+		int level;
+		size_type count;
+		Compare less;
+		SkipListArena arena;
+
+		SkipListMap(const SkipListMap&);
+		SkipListMap& operator=(const SkipListMap&);
+
+		int randomLevel()
+		{
+			int newLevel = 0;
+			for(newLevel = 0; rand() % 2 == 0; newLevel++)
+				;
+			if(newLevel > level + 1)
+				newLevel = level + 1;
+			if(newLevel > MAX_LEVEL)
+				return MAX_LEVEL;
+			return newLevel;
+		}
+
+		//Fills update with the tower before the first node not less than key
+		Node* findGreaterOrEqual(const Key& key, Node*** update)
+		{
+			Node** x = head;
+			for(int i = level; i >= 0; i--)
+			{
+				while(x[i] != NULL && less(x[i]->entry.first, key))
+					x = x[i]->forward;
+				if(update != NULL)
+					update[i] = x;
+			}
+			return x[0];
+		}
+
+		Node* findGreaterOrEqual(const Key& key) const
+		{
+			Node* const* x = head;
+			for(int i = level; i >= 0; i--)
+			{
+				while(x[i] != NULL && less(x[i]->entry.first, key))
+					x = x[i]->forward;
+			}
+			return x[0];
+		}
+
+		Node* findGreater(const Key& key) const
+		{
+			Node* const* x = head;
+			for(int i = level; i >= 0; i--)
+			{
+				while(x[i] != NULL && !less(key, x[i]->entry.first))
+					x = x[i]->forward;
+			}
+			return x[0];
+		}
+
+		void destroyNode(Node* n)
+		{
+			int l = n->level;
+			n->~Node();
+			arena.release(n, Node::bytesFor(l));
+		}
+
+		template <class Ref, class Ptr, class NodePtr>
+		class Iterator{
+
+			private:
+				NodePtr node;
+				friend class SkipListMap;
+
+			public:
+				typedef std::forward_iterator_tag iterator_category;
+				typedef typename SkipListMap::value_type value_type;
+				typedef ptrdiff_t difference_type;
+				typedef Ptr pointer;
+				typedef Ref reference;
+
+				Iterator() : node(NULL) {}
+				explicit Iterator(NodePtr n) : node(n) {}
+				//Lets an iterator convert to a const_iterator
+				template <class R, class P, class N>
+				Iterator(const Iterator<R, P, N>& other) : node(other.node) {}
+
+				Ref operator*() const { return node->entry; }
+				Ptr operator->() const { return &node->entry; }
+				Iterator& operator++() { node = node->forward[0]; return *this; }
+				Iterator operator++(int) { Iterator old = *this; node = node->forward[0]; return old; }
+				bool operator==(const Iterator& other) const { return node == other.node; }
+				bool operator!=(const Iterator& other) const { return node != other.node; }
+
+				template <class R, class P, class N> friend class Iterator;
+		};
+
+	public:
+		typedef Iterator<value_type&, value_type*, Node*> iterator;
+		typedef Iterator<const value_type&, const value_type*, const Node*> const_iterator;
+
+		explicit SkipListMap(const Compare& comp = Compare()) : level(0), count(0), less(comp), arena(alignof(Node))
+		{
+			for(int i = 0; i <= MAX_LEVEL; i++)
+				head[i] = NULL;
+		}
+
+		~SkipListMap()
+		{
+			clear();
+		}
+
+		size_type size() const { return count; }
+		bool empty() const { return count == 0; }
+
+		iterator begin() { return iterator(head[0]); }
+		iterator end() { return iterator(); }
+		const_iterator begin() const { return const_iterator(head[0]); }
+		const_iterator end() const { return const_iterator(); }
+
+		iterator find(const Key& key)
+		{
+			Node* x = findGreaterOrEqual(key);
+			if(x != NULL && !less(key, x->entry.first))
+				return iterator(x);
+			return end();
+		}
+
+		const_iterator find(const Key& key) const
+		{
+			const Node* x = findGreaterOrEqual(key);
+			if(x != NULL && !less(key, x->entry.first))
+				return const_iterator(x);
+			return end();
+		}
+
+		//First entry whose key is not less than key
+		iterator lower_bound(const Key& key) { return iterator(findGreaterOrEqual(key)); }
+		const_iterator lower_bound(const Key& key) const { return const_iterator(findGreaterOrEqual(key)); }
+
+		//First entry whose key is greater than key
+		iterator upper_bound(const Key& key) { return iterator(findGreater(key)); }
+		const_iterator upper_bound(const Key& key) const { return const_iterator(findGreater(key)); }
+
+		/*
+		 * Builds the entry in place from args if key is not present yet.
+		 * Returns the entry for key and whether it was inserted, like std::map.
+		 */
+		template <class K, class... Args>
+		std::pair<iterator, bool> emplace(K&& key, Args&&... args)
+		{
+			Node** update[MAX_LEVEL + 1];
+			Node* x = findGreaterOrEqual(key, update);
+			if(x != NULL && !less(key, x->entry.first))
+			{
+				//Do nothing on duplicate
+				return std::make_pair(iterator(x), false);
+			}
+
+			int l = randomLevel();
+			if(l > level)
+			{
+				for(int i = level + 1; i <= l; i++)
+					update[i] = head;
+				level = l;
+			}
+
+			void* mem = arena.allocate(Node::bytesFor(l));
+			try
+			{
+				x = new (mem) Node(l, std::forward<K>(key), std::forward<Args>(args)...);
+			}
+			catch(...)
+			{
+				arena.release(mem, Node::bytesFor(l));
+				throw;
+			}
+			for(int i = 0; i <= l; i++)
+			{
+				x->forward[i] = update[i][i];
+				update[i][i] = x;
+			}
+			count++;
+			return std::make_pair(iterator(x), true);
+		}
+
+		std::pair<iterator, bool> insert(const Key& key, Value&& value)
+		{
+			return emplace(key, std::move(value));
+		}
+
+		std::pair<iterator, bool> insert(const Key& key, const Value& value)
+		{
+			return emplace(key, value);
+		}
+
+		//Replaces the value of an existing entry instead of ignoring the insert
+		std::pair<iterator, bool> insert_or_assign(const Key& key, Value&& value)
+		{
+			iterator it = find(key);
+			if(it != end())
+			{
+				it->second = std::move(value);
+				return std::make_pair(it, false);
+			}
+			return emplace(key, std::move(value));
+		}
+
+		//Returns the number of entries removed, 0 or 1
+		size_type erase(const Key& key)
+		{
+			Node** update[MAX_LEVEL + 1];
+			Node* x = findGreaterOrEqual(key, update);
+			if(x == NULL || less(key, x->entry.first))
+				return 0;
+
+			for(int i = 0; i <= x->level; i++)
+			{
+				if(update[i][i] == x)
+					update[i][i] = x->forward[i];
+			}
+			destroyNode(x);
+			count--;
+
+			while(level > 0 && head[level] == NULL)
+				level--;
+			return 1;
+		}
+
+		void clear()
+		{
+			Node* x = head[0];
+			while(x != NULL)
+			{
+				Node* next = x->forward[0];
+				x->~Node();
+				x = next;
+			}
+			arena.clear();
+			for(int i = 0; i <= MAX_LEVEL; i++)
+				head[i] = NULL;
+			level = 0;
+			count = 0;
+		}
+
+		//Bytes held by the map's arena
+		size_t memoryFootprint() const
+		{
+			return arena.bytesReserved();
+		}
+};
+
+#endif /* SKIPLISTMAP_H_ */
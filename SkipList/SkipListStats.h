@@ -0,0 +1,99 @@
+/*
+ * SkipListStats.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Hot path counters for SkipList, compiled in only with -DSKIPLIST_STATS.
+ *
+ *  With SKIPLIST_STATS defined, every SkipList counts into per-thread
+ *  counters (see ThreadCounters.h):
+ *
+ *	- each search, and how many nodes it compared against the key
+ *	- how far it walked along level 0 once it got there
+ *	- the height of every tower randomLevel hands out
+ *
+ *  SkipList::stats() adds them up over every thread and every list.  Without
+ *  SKIPLIST_STATS the counting compiles to nothing and the snapshot is all
+ *  zeros.  The macro has to be the same for the whole program.
+ *
+ *  A healthy list compares about 2 log2(n) nodes per search, takes a step or
+ *  two on level 0, and hands out towers whose counts halve at every level.
+ */
+
+#ifndef SKIPLISTSTATS_H_
+#define SKIPLISTSTATS_H_
+
+#include <stdint.h>
+#include "../Common/ThreadCounters.h"
+
+#ifdef SKIPLIST_STATS
+#define SKIPLIST_STATS_ONLY(...) __VA_ARGS__
+#else
+#define SKIPLIST_STATS_ONLY(...)
+#endif
+
+//Tower heights 0 to 32, SkipList::MAX_LEVEL
+static const int SKIPLIST_STATS_HEIGHTS = 33;
+//Level 0 walk lengths from 0 up, the last bucket also counts everything longer
+static const int SKIPLIST_STATS_WALKS = 64;
+
+enum SkipListCounter{
+	SKIPLIST_SEARCHES,
+	SKIPLIST_NODES_VISITED,
+	SKIPLIST_TOWER_HEIGHT,
+	SKIPLIST_LEVEL0_WALK = SKIPLIST_TOWER_HEIGHT + SKIPLIST_STATS_HEIGHTS,
+	SKIPLIST_COUNTERS = SKIPLIST_LEVEL0_WALK + SKIPLIST_STATS_WALKS
+};
+
+struct SkipListStatsTag;
+typedef ThreadCounters<SkipListStatsTag, SKIPLIST_COUNTERS> SkipListCounters;
+
+struct SkipListStats{
+	//False when the program was built without SKIPLIST_STATS
+	bool enabled;
+	uint64_t searches;
+	uint64_t nodesVisited;
+	//towerHeight[l] is the number of towers randomLevel made l levels tall
+	uint64_t towerHeight[SKIPLIST_STATS_HEIGHTS];
+	//level0Walk[s] is the number of searches that took s steps on level 0
+	uint64_t level0Walk[SKIPLIST_STATS_WALKS];
+
+	double nodesPerSearch() const
+	{
+		return searches == 0 ? 0 : (double) nodesVisited / searches;
+	}
+
+	static void countSearch(unsigned long visited, unsigned long level0Steps)
+	{
+		SkipListCounters::add(SKIPLIST_SEARCHES);
+		SkipListCounters::add(SKIPLIST_NODES_VISITED, visited);
+		SkipListCounters::add(SKIPLIST_LEVEL0_WALK + (level0Steps < (unsigned long) SKIPLIST_STATS_WALKS ? level0Steps : SKIPLIST_STATS_WALKS - 1));
+	}
+
+	static void countTower(int height)
+	{
+		SkipListCounters::add(SKIPLIST_TOWER_HEIGHT + height);
+	}
+
+	//The counts so far, summed over every thread
+	static SkipListStats snapshot()
+	{
+		uint64_t values[SKIPLIST_COUNTERS] = {};
+		SkipListStats stats;
+#ifdef SKIPLIST_STATS
+		SkipListCounters::snapshot(values);
+		stats.enabled = true;
+#else
+		stats.enabled = false;
+#endif
+		stats.searches = values[SKIPLIST_SEARCHES];
+		stats.nodesVisited = values[SKIPLIST_NODES_VISITED];
+		for(int l = 0; l < SKIPLIST_STATS_HEIGHTS; l++)
+			stats.towerHeight[l] = values[SKIPLIST_TOWER_HEIGHT + l];
+		for(int s = 0; s < SKIPLIST_STATS_WALKS; s++)
+			stats.level0Walk[s] = values[SKIPLIST_LEVEL0_WALK + s];
+		return stats;
+	}
+};
+
+#endif /* SKIPLISTSTATS_H_ */
@@ -0,0 +1,292 @@
+/*
+ * SortedRun.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Immutable sorted file a MemTable is flushed to, read back through mmap.
+ *
+ *  Layout:
+ *
+ *	data blocks	entries in key order, a new block is started every BLOCK_SIZE bytes
+ *			entry = [key length: 4][flags: 1][value length: 4][key][value]
+ *	index		one entry per block = [offset: 8][size: 4][first key length: 4][first key]
+ *	footer		[index offset: 8][block count: 4][crc32 of index: 4][magic: 4]
+ *
+ *  A lookup binary searches the index for the last block whose first key is not
+ *  greater than the key and scans that block only.  Removed keys are written as
+ *  entries with the TOMBSTONE flag so they hide older values in older runs.
+ */
+
+#ifndef SORTEDRUN_H_
+#define SORTEDRUN_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "WriteAheadLog.h"
+
+class SortedRun{
+
+	public:
+		static const size_t BLOCK_SIZE = 4096;
+		static const uint32_t MAGIC = 0x534B5052;
+		static const unsigned char TOMBSTONE = 1;
+
+		enum LookupResult{ NOT_FOUND, FOUND, DELETED };
+
+	private:
+		static const size_t FOOTER_SIZE = 8 + 4 + 4 + 4;
+
+		struct BlockIndex{
+			uint64_t offset;
+			uint32_t size;
+			const char* firstKey;
+			uint32_t firstKeyLength;
+		};
+
+		std::string path;
+		const char* data;
+		size_t length;
+		std::vector<BlockIndex> index;
+
+		SortedRun(const SortedRun&);
+		SortedRun& operator=(const SortedRun&);
+
+		static void putFixed32(std::string& out, uint32_t v) { out.append(reinterpret_cast<const char*>(&v), 4); }
+		static void putFixed64(std::string& out, uint64_t v) { out.append(reinterpret_cast<const char*>(&v), 8); }
+		static uint32_t getFixed32(const char* p) { uint32_t v; memcpy(&v, p, 4); return v; }
+		static uint64_t getFixed64(const char* p) { uint64_t v; memcpy(&v, p, 8); return v; }
+
+		//Three way compare of raw bytes, shorter wins on a common prefix like std::string
+		static int compare(const char* a, size_t aLength, const char* b, size_t bLength)
+		{
+			int c = memcmp(a, b, aLength < bLength ? aLength : bLength);
+			if(c != 0)
+				return c;
+			return aLength < bLength ? -1 : (aLength > bLength ? 1 : 0);
+		}
+
+		void corrupt(const char* what)
+		{
+			throw std::runtime_error("corrupt sorted run " + path + ": " + what);
+		}
+
+		static void writeAll(int fd, const std::string& bytes, const std::string& path)
+		{
+			const char* p = bytes.data();
+			size_t left = bytes.size();
+			while(left > 0)
+			{
+				ssize_t n = ::write(fd, p, left);
+				if(n < 0)
+				{
+					if(errno == EINTR)
+						continue;
+					throwSystemError("write", path);
+				}
+				p += n;
+				left -= (size_t) n;
+			}
+		}
+
+	public:
+		/*
+		 * Writes the entries in [first, last) to path.  The iterators must yield
+		 * pairs of (key, entry) in ascending key order where entry has a value
+		 * string and a deleted flag.  The file is written under a temporary name,
+		 * synced and then renamed into place, so path only ever holds a whole run.
+		 */
+		template <class Iterator>
+		static void write(const std::string& path, Iterator first, Iterator last)
+		{
+			std::string tmp = path + ".tmp";
+			int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			if(fd < 0)
+				throwSystemError("open", tmp);
+
+			std::string indexBytes;
+			std::string block;
+			uint64_t offset = 0;
+			uint32_t blocks = 0;
+			std::string firstKey;
+
+			try
+			{
+				for(; first != last; ++first)
+				{
+					const std::string& key = first->first;
+					if(block.empty())
+						firstKey = key;
+					putFixed32(block, (uint32_t) key.size());
+					block.push_back(first->second.deleted ? (char) TOMBSTONE : 0);
+					putFixed32(block, (uint32_t) first->second.value.size());
+					block.append(key);
+					block.append(first->second.value);
+
+					if(block.size() >= BLOCK_SIZE)
+					{
+						putFixed64(indexBytes, offset);
+						putFixed32(indexBytes, (uint32_t) block.size());
+						putFixed32(indexBytes, (uint32_t) firstKey.size());
+						indexBytes.append(firstKey);
+						writeAll(fd, block, tmp);
+						offset += block.size();
+						blocks++;
+						block.clear();
+					}
+				}
+				if(!block.empty())
+				{
+					putFixed64(indexBytes, offset);
+					putFixed32(indexBytes, (uint32_t) block.size());
+					putFixed32(indexBytes, (uint32_t) firstKey.size());
+					indexBytes.append(firstKey);
+					writeAll(fd, block, tmp);
+					offset += block.size();
+					blocks++;
+				}
+
+				std::string footer;
+				putFixed64(footer, offset);
+				putFixed32(footer, blocks);
+				putFixed32(footer, crc32(indexBytes.data(), indexBytes.size()));
+				putFixed32(footer, MAGIC);
+				writeAll(fd, indexBytes, tmp);
+				writeAll(fd, footer, tmp);
+				if(::fsync(fd) != 0)
+					throwSystemError("fsync", tmp);
+			}
+			catch(...)
+			{
+				::close(fd);
+				::unlink(tmp.c_str());
+				throw;
+			}
+			::close(fd);
+			if(::rename(tmp.c_str(), path.c_str()) != 0)
+				throwSystemError("rename", path);
+		}
+
+		//Maps the run at path and loads its block index
+		explicit SortedRun(const std::string& p) : path(p), data(NULL), length(0)
+		{
+			int fd = ::open(path.c_str(), O_RDONLY);
+			if(fd < 0)
+				throwSystemError("open", path);
+			struct stat st;
+			if(::fstat(fd, &st) != 0)
+			{
+				::close(fd);
+				throwSystemError("fstat", path);
+			}
+			length = (size_t) st.st_size;
+			if(length < FOOTER_SIZE)
+			{
+				::close(fd);
+				corrupt("too short");
+			}
+			void* mapped = ::mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+			::close(fd);
+			if(mapped == MAP_FAILED)
+				throwSystemError("mmap", path);
+			data = static_cast<const char*>(mapped);
+
+			try
+			{
+				const char* footer = data + length - FOOTER_SIZE;
+				uint64_t indexOffset = getFixed64(footer);
+				uint32_t blocks = getFixed32(footer + 8);
+				uint32_t crc = getFixed32(footer + 12);
+				if(getFixed32(footer + 16) != MAGIC)
+					corrupt("bad magic");
+				if(indexOffset > length - FOOTER_SIZE)
+					corrupt("bad index offset");
+				const char* p = data + indexOffset;
+				const char* end = data + length - FOOTER_SIZE;
+				if(crc32(p, end - p) != crc)
+					corrupt("index checksum mismatch");
+
+				index.reserve(blocks);
+				for(uint32_t i = 0; i < blocks; i++)
+				{
+					if(end - p < 16)
+						corrupt("truncated index");
+					BlockIndex b;
+					b.offset = getFixed64(p);
+					b.size = getFixed32(p + 8);
+					b.firstKeyLength = getFixed32(p + 12);
+					b.firstKey = p + 16;
+					if((size_t) (end - b.firstKey) < b.firstKeyLength || b.offset + b.size > indexOffset)
+						corrupt("bad index entry");
+					p = b.firstKey + b.firstKeyLength;
+					index.push_back(b);
+				}
+			}
+			catch(...)
+			{
+				::munmap(const_cast<char*>(data), length);
+				throw;
+			}
+			//Lookups jump around the file
+			::madvise(const_cast<char*>(data), length, MADV_RANDOM);
+		}
+
+		~SortedRun()
+		{
+			::munmap(const_cast<char*>(data), length);
+		}
+
+		const std::string& getPath() const { return path; }
+
+		//FOUND fills value, DELETED means the key was removed when this run was written
+		LookupResult get(const std::string& key, std::string* value)
+		{
+			//Last block whose first key is <= key
+			size_t lo = 0;
+			size_t hi = index.size();
+			while(lo < hi)
+			{
+				size_t mid = lo + (hi - lo) / 2;
+				if(compare(index[mid].firstKey, index[mid].firstKeyLength, key.data(), key.size()) <= 0)
+					lo = mid + 1;
+				else
+					hi = mid;
+			}
+			if(lo == 0)
+				return NOT_FOUND;
+
+			const BlockIndex& b = index[lo - 1];
+			const char* p = data + b.offset;
+			const char* end = p + b.size;
+			while(end - p >= 9)
+			{
+				uint32_t keyLength = getFixed32(p);
+				unsigned char flags = (unsigned char) p[4];
+				uint32_t valueLength = getFixed32(p + 5);
+				const char* k = p + 9;
+				if((size_t) (end - k) < (size_t) keyLength + valueLength)
+					corrupt("truncated entry");
+				int c = compare(k, keyLength, key.data(), key.size());
+				if(c == 0)
+				{
+					if(flags & TOMBSTONE)
+						return DELETED;
+					if(value != NULL)
+						value->assign(k + keyLength, valueLength);
+					return FOUND;
+				}
+				//Entries are sorted, we have gone past it
+				if(c > 0)
+					break;
+				p = k + keyLength + valueLength;
+			}
+			return NOT_FOUND;
+		}
+};
+
+#endif /* SORTEDRUN_H_ */
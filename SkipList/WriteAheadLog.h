@@ -0,0 +1,197 @@
+/*
+ * WriteAheadLog.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Append-only log of MemTable changes so they survive a crash.
+ *
+ *  Every record is framed as
+ *
+ *	[crc32 of the rest: 4][payload length: 4][type: 1][key length: 4][key][value]
+ *
+ *  and records are appended in batches, each batch followed by one fdatasync.
+ *  Replay stops at the first record that is short or fails its checksum, which is
+ *  where a crash in the middle of a write leaves the log.
+ *
+ *  Local POSIX filesystems only.
+ */
+
+#ifndef WRITEAHEADLOG_H_
+#define WRITEAHEADLOG_H_
+
+#include <string>
+#include <stdexcept>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+//Throws a runtime_error naming the failed call, the path and errno's message
+inline void throwSystemError(const char* call, const std::string& path)
+{
+	throw std::runtime_error(std::string(call) + "(" + path + "): " + strerror(errno));
+}
+
+//Lookup table for crc32, built once on first use
+struct Crc32Table{
+	uint32_t entries[256];
+
+	Crc32Table()
+	{
+		for(uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t c = i;
+			for(int k = 0; k < 8; k++)
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			entries[i] = c;
+		}
+	}
+};
+
+//Standard reflected CRC-32, used by the log and the sorted runs
+inline uint32_t crc32(const char* data, size_t length)
+{
+	static const Crc32Table table;
+	uint32_t crc = 0xFFFFFFFFu;
+	for(size_t i = 0; i < length; i++)
+		crc = table.entries[(crc ^ (unsigned char) data[i]) & 0xFF] ^ (crc >> 8);
+	return crc ^ 0xFFFFFFFFu;
+}
+
+class WriteAheadLog{
+
+	public:
+		enum RecordType{ PUT = 1, REMOVE = 2 };
+
+	private:
+		std::string path;
+		int fd;
+
+		WriteAheadLog(const WriteAheadLog&);
+		WriteAheadLog& operator=(const WriteAheadLog&);
+
+		static void putFixed32(std::string& out, uint32_t v)
+		{
+			out.append(reinterpret_cast<const char*>(&v), 4);
+		}
+
+		static uint32_t getFixed32(const char* p)
+		{
+			uint32_t v;
+			memcpy(&v, p, 4);
+			return v;
+		}
+
+	public:
+		//Opens path for appending, creating it if needed
+		explicit WriteAheadLog(const std::string& p) : path(p)
+		{
+			fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+			if(fd < 0)
+				throwSystemError("open", path);
+		}
+
+		~WriteAheadLog()
+		{
+			::close(fd);
+		}
+
+		const std::string& getPath() const { return path; }
+
+		//Appends one framed record to buffer
+		static void encode(std::string& buffer, RecordType type, const std::string& key, const std::string& value)
+		{
+			size_t start = buffer.size();
+			uint32_t payload = (uint32_t) (1 + 4 + key.size() + value.size());
+			putFixed32(buffer, 0);
+			putFixed32(buffer, payload);
+			buffer.push_back((char) type);
+			putFixed32(buffer, (uint32_t) key.size());
+			buffer.append(key);
+			buffer.append(value);
+			uint32_t crc = crc32(&buffer[start + 4], 4 + payload);
+			memcpy(&buffer[start], &crc, 4);
+		}
+
+		//Writes a batch of encoded records and waits until it is on disk
+		void append(const std::string& batch)
+		{
+			const char* p = batch.data();
+			size_t left = batch.size();
+			while(left > 0)
+			{
+				ssize_t n = ::write(fd, p, left);
+				if(n < 0)
+				{
+					if(errno == EINTR)
+						continue;
+					throwSystemError("write", path);
+				}
+				p += n;
+				left -= (size_t) n;
+			}
+			if(::fdatasync(fd) != 0)
+				throwSystemError("fdatasync", path);
+		}
+
+		/*
+		 * Calls apply(type, key, value) for every intact record in the log at path.
+		 * A torn or corrupt tail is cut off so later appends follow the last good
+		 * record.  Returns the number of records replayed.
+		 */
+		template <class Apply>
+		static size_t replay(const std::string& path, Apply apply)
+		{
+			int in = ::open(path.c_str(), O_RDONLY);
+			if(in < 0)
+				throwSystemError("open", path);
+			struct stat st;
+			if(::fstat(in, &st) != 0)
+			{
+				::close(in);
+				throwSystemError("fstat", path);
+			}
+			std::string data((size_t) st.st_size, '\0');
+			size_t got = 0;
+			while(got < data.size())
+			{
+				ssize_t n = ::read(in, &data[got], data.size() - got);
+				if(n < 0 && errno == EINTR)
+					continue;
+				if(n <= 0)
+					break;
+				got += (size_t) n;
+			}
+			::close(in);
+			data.resize(got);
+
+			size_t offset = 0;
+			size_t records = 0;
+			while(data.size() - offset >= 8)
+			{
+				uint32_t crc = getFixed32(&data[offset]);
+				uint32_t payload = getFixed32(&data[offset + 4]);
+				if(payload < 5 || data.size() - offset - 8 < payload)
+					break;
+				if(crc32(&data[offset + 4], 4 + payload) != crc)
+					break;
+				const char* p = &data[offset + 8];
+				uint32_t keyLength = getFixed32(p + 1);
+				if(keyLength > payload - 5)
+					break;
+				std::string key(p + 5, keyLength);
+				std::string value(p + 5 + keyLength, payload - 5 - keyLength);
+				apply((RecordType) p[0], key, value);
+				offset += 8 + payload;
+				records++;
+			}
+
+			if(offset < (size_t) st.st_size && ::truncate(path.c_str(), (off_t) offset) != 0)
+				throwSystemError("truncate", path);
+			return records;
+		}
+};
+
+#endif /* WRITEAHEADLOG_H_ */
@@ -6,7 +6,9 @@
  */
 
 #include <iostream>
+#include <string>
 #include "SkipList.cpp"
+#include "SkipListMap.h"
 
 using namespace std;
 
@@ -34,6 +36,15 @@ int main() {
   cout << S.search(200) << endl;
   cout << S.search(40) << endl;
 
+  SkipListMap<int, string> M;
+  M.insert(30, "thirty");
+  M.insert(10, "ten");
+  M.insert(20, "twenty");
+  M.insert(40, "forty");
+  cout << "Range [15, 35)" << endl;
+  for(SkipListMap<int, string>::iterator it = M.lower_bound(15); it != M.end() && it->first < 35; ++it)
+    cout << it->first << " " << it->second << endl;
+
   return 0;
 }
 